@@ -1 +1,25 @@
 # File for module specific CMake tests.
+
+# zlib is optional, it enables compressed VTU output
+find_package(ZLIB)
+if(ZLIB_FOUND)
+  set(HAVE_ZLIB ${ZLIB_FOUND})
+  dune_register_package_flags(LIBRARIES ZLIB::ZLIB
+                              COMPILE_DEFINITIONS "ENABLE_ZLIB=1")
+endif()
+
+# HDF5 is optional, it enables the HDF5/XDMF series output. The writer uses the serial C library, a parallel
+# build would require MPI in every target. HDF5_INCLUDE_DIRS and HDF5_LIBRARIES are the documented results of
+# FindHDF5, the per component variables are not set by all versions, and wrapper based detection reports its
+# preprocessor flags in HDF5_DEFINITIONS
+find_package(HDF5 COMPONENTS C)
+if(HDF5_FOUND AND HDF5_IS_PARALLEL)
+  message(STATUS "Parallel HDF5 found, the HDF5/XDMF series output requires the serial library and is disabled")
+elseif(HDF5_FOUND)
+  set(HAVE_HDF5 TRUE)
+  string(REGEX REPLACE "^-D" "" _hdf5_definitions "${HDF5_DEFINITIONS}")
+  string(REGEX REPLACE ";-D" ";" _hdf5_definitions "${_hdf5_definitions}")
+  dune_register_package_flags(LIBRARIES ${HDF5_LIBRARIES}
+                              INCLUDE_DIRS ${HDF5_INCLUDE_DIRS}
+                              COMPILE_DEFINITIONS "ENABLE_HDF5=1" ${_hdf5_definitions})
+endif()
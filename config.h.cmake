@@ -40,6 +40,12 @@
 /* Define to the revision of duneuro_eeg_forward_test */
 #define DUNEURO_EEG_FORWARD_TEST_VERSION_REVISION @DUNEURO_EEG_FORWARD_TEST_VERSION_REVISION@
 
+/* Define to 1 if zlib is found and can be used for compressed output */
+#cmakedefine HAVE_ZLIB ENABLE_ZLIB
+
+/* Define to 1 if HDF5 is found and can be used for the series output */
+#cmakedefine HAVE_HDF5 ENABLE_HDF5
+
 /* end duneuro_eeg_forward_test
    Everything below here will be overwritten
 */
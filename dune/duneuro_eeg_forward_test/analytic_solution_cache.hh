@@ -0,0 +1,226 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_ANALYTIC_SOLUTION_CACHE_HH
+#define DUNEURO_EEG_FORWARD_TEST_ANALYTIC_SOLUTION_CACHE_HH
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/hash.hh>
+#include <dune/duneuro_eeg_forward_test/mapped_file.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // identification of the setup of the analytical solution, i.e. everything but the dipole the potentials depend on
+  template<std::size_t number_of_layers>
+  std::uint64_t analytic_setup_hash(const std::string& method,
+                                    const std::array<double, number_of_layers>& radii,
+                                    const std::array<double, 3>& center,
+                                    const std::array<double, number_of_layers>& conductivities,
+                                    const std::vector<std::array<double, 3>>& electrodes)
+  {
+    Hash hash;
+    hash.add(method).add(radii).add(center).add(conductivities);
+    hash.add_bytes(electrodes.data(), electrodes.size() * sizeof(electrodes[0]));
+    return hash.value();
+  }
+
+  inline std::uint64_t analytic_dipole_hash(const std::array<double, 3>& position, const std::array<double, 3>& moment)
+  {
+    return Hash().add(position).add(moment).value();
+  }
+
+  // on disk cache of analytical electrode potentials. The cache belongs to one setup, i.e. radii, center,
+  // conductivities and electrodes, identified by setup_hash. Its entries map a hash of the dipole to the
+  // potential at every electrode. A cache file written for a different setup is ignored.
+  // find and insert may be called concurrently.
+  class AnalyticSolutionCache {
+  public:
+    AnalyticSolutionCache(std::string filename, std::uint64_t setup_hash, std::size_t number_of_electrodes)
+      : filename_(std::move(filename))
+      , setup_hash_(setup_hash)
+      , number_of_electrodes_(number_of_electrodes)
+    {
+      read(entries_);
+    }
+
+    bool find(std::uint64_t dipole_hash, std::vector<double>& potentials)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(dipole_hash);
+      if(it == entries_.end()) {
+        ++misses_;
+        return false;
+      }
+      ++hits_;
+      potentials = it->second;
+      return true;
+    }
+
+    void insert(std::uint64_t dipole_hash, const std::vector<double>& potentials)
+    {
+      if(potentials.size() != number_of_electrodes_) {
+        DUNE_THROW(Dune::RangeError, "expected " << number_of_electrodes_ << " potentials, got " << potentials.size());
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      entries_[dipole_hash] = potentials;
+      modified_ = true;
+    }
+
+    // write the cache if new entries were added. Processes saving the same cache, e.g. the MPI ranks, are
+    // serialized by an exclusive lock on filename.lock. While holding it, the entries written to the file by
+    // other processes in the meantime are merged and the file is replaced atomically
+    void save()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(!modified_) {
+        return;
+      }
+      FileLock file_lock(filename_ + ".lock");
+      Entries entries;
+      read(entries);
+      for(const auto& entry : entries_) {
+        entries[entry.first] = entry.second;
+      }
+
+      Header header = make_header(entries.size());
+      std::string temporary_filename = filename_ + ".tmp" + std::to_string(::getpid());
+      {
+        std::ofstream out(temporary_filename, std::ios::binary);
+        if(!out) {
+          DUNE_THROW(Dune::IOError, "could not open " << temporary_filename);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(const auto& entry : entries) {
+          out.write(reinterpret_cast<const char*>(&entry.first), sizeof(entry.first));
+          out.write(reinterpret_cast<const char*>(entry.second.data()), number_of_electrodes_ * sizeof(double));
+        }
+        if(!out) {
+          DUNE_THROW(Dune::IOError, "error while writing " << temporary_filename);
+        }
+      }
+      if(std::rename(temporary_filename.c_str(), filename_.c_str()) != 0) {
+        std::remove(temporary_filename.c_str());
+        DUNE_THROW(Dune::IOError, "could not rename " << temporary_filename << " to " << filename_);
+      }
+      modified_ = false;
+    }
+
+    std::size_t hits() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return hits_;
+    }
+
+    std::size_t misses() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return misses_;
+    }
+
+  private:
+    using Entries = std::unordered_map<std::uint64_t, std::vector<double>>;
+
+    // exclusive advisory lock of a file, which is created if necessary. The lock is released by the destructor
+    class FileLock {
+    public:
+      explicit FileLock(const std::string& filename)
+        : descriptor_(::open(filename.c_str(), O_RDWR | O_CREAT, 0644))
+      {
+        if(descriptor_ < 0) {
+          DUNE_THROW(Dune::IOError, "could not open " << filename);
+        }
+        if(::flock(descriptor_, LOCK_EX) != 0) {
+          ::close(descriptor_);
+          DUNE_THROW(Dune::IOError, "could not lock " << filename);
+        }
+      }
+
+      FileLock(const FileLock&) = delete;
+      FileLock& operator=(const FileLock&) = delete;
+
+      ~FileLock()
+      {
+        ::flock(descriptor_, LOCK_UN);
+        ::close(descriptor_);
+      }
+
+    private:
+      int descriptor_;
+    };
+
+    struct Header {
+      char magic[8];
+      std::uint64_t version;
+      std::uint64_t setup_hash;
+      std::uint64_t number_of_electrodes;
+      std::uint64_t number_of_entries;
+    };
+
+    static constexpr std::uint64_t version_ = 1;
+
+    Header make_header(std::size_t number_of_entries) const
+    {
+      Header header;
+      std::memcpy(header.magic, "DNANCACH", sizeof(header.magic));
+      header.version = version_;
+      header.setup_hash = setup_hash_;
+      header.number_of_electrodes = number_of_electrodes_;
+      header.number_of_entries = number_of_entries;
+      return header;
+    }
+
+    // add the entries stored in the cache file, if it exists and belongs to the current setup
+    void read(Entries& entries) const
+    {
+      struct stat file_status;
+      if(::stat(filename_.c_str(), &file_status) != 0) {
+        return;
+      }
+      MappedFile file(filename_);
+      Header header;
+      if(file.size() < sizeof(header)) {
+        return;
+      }
+      std::memcpy(&header, file.data(), sizeof(header));
+      Header expected = make_header(header.number_of_entries);
+      std::size_t entry_size = sizeof(std::uint64_t) + number_of_electrodes_ * sizeof(double);
+      if(std::memcmp(&header, &expected, sizeof(header)) != 0
+         || file.size() != sizeof(header) + header.number_of_entries * entry_size) {
+        return;
+      }
+      const char* position = file.data() + sizeof(header);
+      for(std::uint64_t i = 0; i < header.number_of_entries; ++i) {
+        std::uint64_t key;
+        std::memcpy(&key, position, sizeof(key));
+        std::vector<double> potentials(number_of_electrodes_);
+        std::memcpy(potentials.data(), position + sizeof(key), number_of_electrodes_ * sizeof(double));
+        entries.emplace(key, std::move(potentials));
+        position += entry_size;
+      }
+    }
+
+    std::string filename_;
+    std::uint64_t setup_hash_;
+    std::size_t number_of_electrodes_;
+    Entries entries_;
+    bool modified_ = false;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+    mutable std::mutex mutex_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_ANALYTIC_SOLUTION_CACHE_HH
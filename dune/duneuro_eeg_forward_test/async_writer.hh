@@ -0,0 +1,137 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_ASYNC_WRITER_HH
+#define DUNEURO_EEG_FORWARD_TEST_ASYNC_WRITER_HH
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace duneuro_eeg_forward_test {
+
+  // runs output tasks on a background thread in the order they were submitted, so that the caller can go on
+  // computing while files are written. A task has to own the data it writes, e.g. by capturing a copy of the
+  // solution, since the caller is free to overwrite its own data after submitting. At most max_pending tasks are
+  // queued, submit blocks beyond that to bound the memory held by the snapshots.
+  // If a task throws, the remaining tasks are dropped and the exception is rethrown by the next call of submit or
+  // wait. With asynchronous = false the tasks are run directly by submit, which gives the synchronous behavior
+  // without changing the calling code. submit may be called concurrently. A task and the data it owns are destroyed
+  // before wait returns, so it may refer to objects the caller destroys after wait
+  class AsyncWriter {
+  public:
+    explicit AsyncWriter(bool asynchronous = true, std::size_t max_pending = 4)
+      : asynchronous_(asynchronous)
+      , max_pending_(std::max<std::size_t>(max_pending, 1))
+    {
+      if(asynchronous_) {
+        thread_ = std::thread([this] () { run(); });
+      }
+    }
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // finishes the pending tasks. Exceptions can not be reported here, call wait before to see them
+    ~AsyncWriter()
+    {
+      if(asynchronous_) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stopping_ = true;
+        }
+        task_available_.notify_one();
+        thread_.join();
+      }
+    }
+
+    void submit(std::function<void()> task)
+    {
+      if(!asynchronous_) {
+        task();
+        return;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      space_available_.wait(lock, [this] () { return tasks_.size() < max_pending_ || exception_; });
+      rethrow(lock);
+      tasks_.push_back(std::move(task));
+      lock.unlock();
+      task_available_.notify_one();
+    }
+
+    // block until all submitted tasks are finished
+    void wait()
+    {
+      if(!asynchronous_) {
+        return;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      idle_.wait(lock, [this] () { return (tasks_.empty() && !busy_) || exception_; });
+      rethrow(lock);
+    }
+
+  private:
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while(true) {
+        task_available_.wait(lock, [this] () { return !tasks_.empty() || stopping_; });
+        if(tasks_.empty()) {
+          return;
+        }
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        busy_ = true;
+        lock.unlock();
+        space_available_.notify_one();
+        try {
+          task();
+        }
+        catch(...) {
+          lock.lock();
+          exception_ = std::current_exception();
+          tasks_.clear();
+          busy_ = false;
+          lock.unlock();
+          space_available_.notify_all();
+          idle_.notify_all();
+          lock.lock();
+          continue;
+        }
+        lock.lock();
+        busy_ = false;
+        if(tasks_.empty()) {
+          idle_.notify_all();
+        }
+      }
+    }
+
+    // rethrow the exception of a failed task once
+    void rethrow(std::unique_lock<std::mutex>& lock)
+    {
+      if(exception_) {
+        std::exception_ptr exception = exception_;
+        exception_ = nullptr;
+        lock.unlock();
+        std::rethrow_exception(exception);
+      }
+    }
+
+    bool asynchronous_;
+    std::size_t max_pending_;
+    std::deque<std::function<void()>> tasks_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::exception_ptr exception_;
+    std::mutex mutex_;
+    std::condition_variable task_available_;
+    std::condition_variable space_available_;
+    std::condition_variable idle_;
+    std::thread thread_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_ASYNC_WRITER_HH
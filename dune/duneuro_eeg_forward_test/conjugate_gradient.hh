@@ -0,0 +1,241 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_CONJUGATE_GRADIENT_HH
+#define DUNEURO_EEG_FORWARD_TEST_CONJUGATE_GRADIENT_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/sparse_matrix.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  struct SolverResult {
+    std::size_t iterations = 0;
+    // norm of the final residual relative to the norm of the right hand side
+    double reduction = 0.0;
+    bool converged = false;
+    // number of outer iterations of mixed precision solves, for which iterations counts the inner iterations
+    std::size_t refinements = 0;
+  };
+
+  template<class T>
+  double dot(const std::vector<T>& x, const std::vector<T>& y)
+  {
+    double sum = 0.0;
+    for(std::size_t i = 0; i < x.size(); ++i) {
+      sum += static_cast<double>(x[i]) * y[i];
+    }
+    return sum;
+  }
+
+  // inverse of the diagonal, i.e. the Jacobi preconditioner. Zero rows of the diagonal are left unpreconditioned
+  template<class T>
+  std::vector<T> inverse_diagonal(const SparseMatrix<T>& matrix)
+  {
+    std::vector<T> result = matrix.diagonal();
+    for(auto& entry : result) {
+      entry = entry != T(0) ? T(1) / entry : T(1);
+    }
+    return result;
+  }
+
+  // Jacobi preconditioned conjugate gradients for A x = b, starting from the x passed in. The iteration stops once
+  // |b - A x| <= reduction |b|. The criterion is relative to the right hand side instead of the initial residual,
+  // so that a good initial guess saves iterations instead of tightening the criterion. For the singular matrix of
+  // the pure Neumann problem b has to be orthogonal to the constant vectors, the solution is then unique up to a constant.
+  template<class T>
+  SolverResult conjugate_gradient(const SparseMatrix<T>& matrix,
+                                  const std::vector<T>& preconditioner,
+                                  const std::vector<T>& b,
+                                  std::vector<T>& x,
+                                  double reduction,
+                                  std::size_t max_iterations)
+  {
+    std::size_t size = matrix.size;
+    if(b.size() != size || x.size() != size) {
+      DUNE_THROW(Dune::RangeError, "matrix of size " << size << " does not match vectors of size " << b.size() << " and " << x.size());
+    }
+
+    SolverResult result;
+    std::vector<T> r(size), z(size), p(size), q(size);
+    matrix.multiply(x.data(), q.data());
+    for(std::size_t i = 0; i < size; ++i) {
+      r[i] = b[i] - q[i];
+    }
+
+    double norm_b = std::sqrt(dot(b, b));
+    if(norm_b == 0.0) {
+      x.assign(size, T(0));
+      result.converged = true;
+      return result;
+    }
+    double target = reduction * norm_b;
+    double norm_r = std::sqrt(dot(r, r));
+
+    for(std::size_t i = 0; i < size; ++i) {
+      z[i] = preconditioner[i] * r[i];
+      p[i] = z[i];
+    }
+    double rho = dot(r, z);
+
+    while(norm_r > target && result.iterations < max_iterations) {
+      matrix.multiply(p.data(), q.data());
+      double alpha = rho / dot(p, q);
+      for(std::size_t i = 0; i < size; ++i) {
+        x[i] += static_cast<T>(alpha) * p[i];
+        r[i] -= static_cast<T>(alpha) * q[i];
+        z[i] = preconditioner[i] * r[i];
+      }
+      ++result.iterations;
+      norm_r = std::sqrt(dot(r, r));
+
+      double rho_next = dot(r, z);
+      double beta = rho_next / rho;
+      rho = rho_next;
+      for(std::size_t i = 0; i < size; ++i) {
+        p[i] = z[i] + static_cast<T>(beta) * p[i];
+      }
+    }
+
+    result.reduction = norm_r / norm_b;
+    result.converged = norm_r <= target;
+    return result;
+  }
+
+  namespace cg_detail {
+    // fixed_block_size is either 0 or equal to block_size. In the latter case the loops over the vectors of the
+    // block have a compile time length, the per vector scalars live in registers and the loops are vectorized
+    template<class T, std::size_t fixed_block_size>
+    SolverResult block_conjugate_gradient(const SparseMatrix<T>& matrix,
+                                          const std::vector<T>& preconditioner,
+                                          const std::vector<T>& b,
+                                          std::vector<T>& x,
+                                          std::size_t block_size,
+                                          double reduction,
+                                          std::size_t max_iterations)
+    {
+      using Scalars = std::conditional_t<fixed_block_size != 0, std::array<double, fixed_block_size>, std::vector<double>>;
+      const std::size_t k = fixed_block_size != 0 ? fixed_block_size : block_size;
+      const std::size_t size = matrix.size;
+      if(b.size() != size * k || x.size() != size * k) {
+        DUNE_THROW(Dune::RangeError, "matrix of size " << size << " does not match block vectors of size " << b.size() << " and " << x.size());
+      }
+
+      auto make_scalars = [k] () {
+        Scalars scalars{};
+        if constexpr (fixed_block_size == 0) {
+          scalars.assign(k, 0.0);
+        }
+        return scalars;
+      };
+      // column wise dot products of two block vectors
+      auto block_dot = [&] (const std::vector<T>& u, const std::vector<T>& v) {
+        Scalars result = make_scalars();
+        for(std::size_t i = 0; i < size; ++i) {
+          for(std::size_t j = 0; j < k; ++j) {
+            result[j] += static_cast<double>(u[i * k + j]) * v[i * k + j];
+          }
+        }
+        return result;
+      };
+
+      std::vector<T> r(size * k), z(size * k), p(size * k), q(size * k);
+      matrix.multiply_block(x.data(), q.data(), k);
+      for(std::size_t index = 0; index < size * k; ++index) {
+        r[index] = b[index] - q[index];
+      }
+      for(std::size_t i = 0; i < size; ++i) {
+        for(std::size_t j = 0; j < k; ++j) {
+          z[i * k + j] = preconditioner[i] * r[i * k + j];
+        }
+      }
+      p = z;
+
+      Scalars norm_b = block_dot(b, b);
+      Scalars norm_r = block_dot(r, r);
+      Scalars rho = block_dot(r, z);
+      Scalars target = make_scalars();
+      std::vector<bool> active(k);
+      for(std::size_t j = 0; j < k; ++j) {
+        norm_b[j] = std::sqrt(norm_b[j]);
+        norm_r[j] = std::sqrt(norm_r[j]);
+        target[j] = reduction * norm_b[j];
+        active[j] = norm_r[j] > target[j];
+      }
+
+      SolverResult result;
+      Scalars alpha = make_scalars();
+      Scalars beta = make_scalars();
+      while(std::find(active.begin(), active.end(), true) != active.end() && result.iterations < max_iterations) {
+        matrix.multiply_block(p.data(), q.data(), k);
+        Scalars pq = block_dot(p, q);
+        for(std::size_t j = 0; j < k; ++j) {
+          alpha[j] = active[j] ? rho[j] / pq[j] : 0.0;
+        }
+        for(std::size_t i = 0; i < size; ++i) {
+          for(std::size_t j = 0; j < k; ++j) {
+            std::size_t index = i * k + j;
+            x[index] += static_cast<T>(alpha[j]) * p[index];
+            r[index] -= static_cast<T>(alpha[j]) * q[index];
+            z[index] = preconditioner[i] * r[index];
+          }
+        }
+        ++result.iterations;
+
+        norm_r = block_dot(r, r);
+        Scalars rho_next = block_dot(r, z);
+        for(std::size_t j = 0; j < k; ++j) {
+          norm_r[j] = std::sqrt(norm_r[j]);
+          beta[j] = active[j] ? rho_next[j] / rho[j] : 0.0;
+          rho[j] = rho_next[j];
+          active[j] = active[j] && norm_r[j] > target[j];
+        }
+        for(std::size_t i = 0; i < size; ++i) {
+          for(std::size_t j = 0; j < k; ++j) {
+            std::size_t index = i * k + j;
+            p[index] = z[index] + static_cast<T>(beta[j]) * p[index];
+          }
+        }
+      }
+
+      result.converged = true;
+      for(std::size_t j = 0; j < k; ++j) {
+        double column_reduction = norm_b[j] > 0.0 ? norm_r[j] / norm_b[j] : 0.0;
+        result.reduction = std::max(result.reduction, column_reduction);
+        result.converged = result.converged && (norm_b[j] == 0.0 || norm_r[j] <= target[j]);
+      }
+      return result;
+    }
+  } // namespace cg_detail
+
+  // conjugate_gradient for block_size right hand sides at once, stored interleaved as for SparseMatrix::multiply_block.
+  // Every vector follows its own CG recurrence, but the matrix is traversed once per iteration for all of them, which
+  // makes an iteration much cheaper than block_size single vector iterations when the solve is memory bound.
+  // Vectors that have converged are no longer updated. The result reports the largest number of iterations and the
+  // largest reduction over the vectors
+  template<class T>
+  SolverResult block_conjugate_gradient(const SparseMatrix<T>& matrix,
+                                        const std::vector<T>& preconditioner,
+                                        const std::vector<T>& b,
+                                        std::vector<T>& x,
+                                        std::size_t block_size,
+                                        double reduction,
+                                        std::size_t max_iterations)
+  {
+    switch(block_size) {
+      case 2: return cg_detail::block_conjugate_gradient<T, 2>(matrix, preconditioner, b, x, block_size, reduction, max_iterations);
+      case 4: return cg_detail::block_conjugate_gradient<T, 4>(matrix, preconditioner, b, x, block_size, reduction, max_iterations);
+      case 8: return cg_detail::block_conjugate_gradient<T, 8>(matrix, preconditioner, b, x, block_size, reduction, max_iterations);
+      case 16: return cg_detail::block_conjugate_gradient<T, 16>(matrix, preconditioner, b, x, block_size, reduction, max_iterations);
+      default: return cg_detail::block_conjugate_gradient<T, 0>(matrix, preconditioner, b, x, block_size, reduction, max_iterations);
+    }
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_CONJUGATE_GRADIENT_HH
@@ -0,0 +1,164 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_DIPOLE_ERRORS_HH
+#define DUNEURO_EEG_FORWARD_TEST_DIPOLE_ERRORS_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // result of comparing the numerical and the analytical solution for a single dipole
+  struct DipoleErrors {
+    double norm_analytical = 0.0;
+    double norm_numerical = 0.0;
+    double relative_error = 0.0;
+    double mag = 0.0;
+    double rdm = 0.0;
+  };
+
+  // compute norms, relative error, MAG and RDM of the numerical with respect to the analytical solution in a single pass
+  // without allocating. The sums are split over independent accumulators, so that the loop can be vectorized without
+  // reassociating floating point operations. The RDM is obtained from
+  //   |n/|n| - a/|a||^2 = (|n - a|^2 - (|n| - |a|)^2) / (|n| |a|),
+  // which avoids the cancellation of the equivalent form 2 - 2 (n.a) / (|n| |a|) for accurate solutions
+  inline DipoleErrors compute_dipole_errors(const double* numerical_solution, const double* analytical_solution, std::size_t size)
+  {
+    constexpr std::size_t accumulators = 4;
+    double sum_numerical[accumulators] = {};
+    double sum_analytical[accumulators] = {};
+    double sum_difference[accumulators] = {};
+
+    std::size_t blocked_size = size - size % accumulators;
+    for(std::size_t i = 0; i < blocked_size; i += accumulators) {
+      for(std::size_t j = 0; j < accumulators; ++j) {
+        double numerical = numerical_solution[i + j];
+        double analytical = analytical_solution[i + j];
+        double difference = numerical - analytical;
+        sum_numerical[j] += numerical * numerical;
+        sum_analytical[j] += analytical * analytical;
+        sum_difference[j] += difference * difference;
+      }
+    }
+    for(std::size_t i = blocked_size; i < size; ++i) {
+      double difference = numerical_solution[i] - analytical_solution[i];
+      sum_numerical[0] += numerical_solution[i] * numerical_solution[i];
+      sum_analytical[0] += analytical_solution[i] * analytical_solution[i];
+      sum_difference[0] += difference * difference;
+    }
+
+    double squared_norm_numerical = (sum_numerical[0] + sum_numerical[1]) + (sum_numerical[2] + sum_numerical[3]);
+    double squared_norm_analytical = (sum_analytical[0] + sum_analytical[1]) + (sum_analytical[2] + sum_analytical[3]);
+    double squared_norm_difference = (sum_difference[0] + sum_difference[1]) + (sum_difference[2] + sum_difference[3]);
+
+    DipoleErrors errors;
+    errors.norm_numerical = std::sqrt(squared_norm_numerical);
+    errors.norm_analytical = std::sqrt(squared_norm_analytical);
+    errors.relative_error = std::sqrt(squared_norm_difference) / errors.norm_analytical;
+    errors.mag = errors.norm_numerical / errors.norm_analytical;
+    double norm_difference = errors.norm_numerical - errors.norm_analytical;
+    errors.rdm = std::sqrt(std::max(0.0, squared_norm_difference - norm_difference * norm_difference)
+                           / (errors.norm_numerical * errors.norm_analytical));
+    return errors;
+  }
+
+  inline DipoleErrors compute_dipole_errors(const std::vector<double>& numerical_solution, const std::vector<double>& analytical_solution)
+  {
+    if(numerical_solution.size() != analytical_solution.size()) {
+      DUNE_THROW(Dune::RangeError, "numerical solution has " << numerical_solution.size() << " entries, analytical solution " << analytical_solution.size());
+    }
+    return compute_dipole_errors(numerical_solution.data(), analytical_solution.data(), numerical_solution.size());
+  }
+
+  // summary of one error measure over a set of dipoles
+  struct ErrorStatistics {
+    double mean = 0.0;
+    double standard_deviation = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+  };
+
+  // compute statistics of the error measure selected by member, e.g. &DipoleErrors::rdm
+  inline ErrorStatistics compute_statistics(const std::vector<DipoleErrors>& errors, double DipoleErrors::* member)
+  {
+    ErrorStatistics statistics;
+    if(errors.empty()) {
+      return statistics;
+    }
+    statistics.min = std::numeric_limits<double>::max();
+    statistics.max = std::numeric_limits<double>::lowest();
+    double sum = 0.0;
+    for(const auto& error : errors) {
+      double value = error.*member;
+      sum += value;
+      statistics.min = std::min(statistics.min, value);
+      statistics.max = std::max(statistics.max, value);
+    }
+    statistics.mean = sum / errors.size();
+    double squared_deviations = 0.0;
+    for(const auto& error : errors) {
+      double deviation = error.*member - statistics.mean;
+      squared_deviations += deviation * deviation;
+    }
+    statistics.standard_deviation = std::sqrt(squared_deviations / errors.size());
+    return statistics;
+  }
+
+  // print the errors of every dipole followed by aggregate statistics
+  inline void print_batch_report(std::ostream& out, const std::vector<DipoleErrors>& errors, bool print_per_dipole = true)
+  {
+    if(print_per_dipole) {
+      out << " Per dipole errors\n";
+      out << std::setw(8) << "dipole" << std::setw(16) << "RE" << std::setw(16) << "MAG" << std::setw(16) << "RDM" << "\n";
+      for(std::size_t i = 0; i < errors.size(); ++i) {
+        out << std::setw(8) << i
+            << std::setw(16) << errors[i].relative_error
+            << std::setw(16) << errors[i].mag
+            << std::setw(16) << errors[i].rdm << "\n";
+      }
+    }
+
+    out << " Statistics over " << errors.size() << " dipoles\n";
+    out << std::setw(8) << "" << std::setw(16) << "mean" << std::setw(16) << "std" << std::setw(16) << "min" << std::setw(16) << "max" << "\n";
+    auto print_line = [&out, &errors] (const std::string& name, double DipoleErrors::* member) {
+      ErrorStatistics statistics = compute_statistics(errors, member);
+      out << std::setw(8) << name
+          << std::setw(16) << statistics.mean
+          << std::setw(16) << statistics.standard_deviation
+          << std::setw(16) << statistics.min
+          << std::setw(16) << statistics.max << "\n";
+    };
+    print_line("RE", &DipoleErrors::relative_error);
+    print_line("MAG", &DipoleErrors::mag);
+    print_line("RDM", &DipoleErrors::rdm);
+  }
+
+  // write the errors of every dipole as csv
+  inline void write_batch_csv(const std::string& filename, const std::vector<DipoleErrors>& errors)
+  {
+    std::ofstream out(filename);
+    if(!out) {
+      DUNE_THROW(Dune::IOError, "could not open " << filename);
+    }
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << "dipole,norm_analytical,norm_numerical,re,mag,rdm\n";
+    for(std::size_t i = 0; i < errors.size(); ++i) {
+      out << i << ","
+          << errors[i].norm_analytical << ","
+          << errors[i].norm_numerical << ","
+          << errors[i].relative_error << ","
+          << errors[i].mag << ","
+          << errors[i].rdm << "\n";
+    }
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_DIPOLE_ERRORS_HH
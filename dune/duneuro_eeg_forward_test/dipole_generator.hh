@@ -0,0 +1,87 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_DIPOLE_GENERATOR_HH
+#define DUNEURO_EEG_FORWARD_TEST_DIPOLE_GENERATOR_HH
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/electrode_generator.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // position and unit moment of a generated dipole
+  struct GeneratedDipole {
+    std::array<double, 3> position;
+    std::array<double, 3> moment;
+  };
+
+  // dipoles on number_of_eccentricities concentric spheres inside the innermost layer. The eccentricities, i.e. the
+  // distances to the center relative to inner_radius, are spaced evenly in [eccentricity_min, eccentricity_max].
+  // On every sphere the dipoles are placed in number_of_directions directions of a Fibonacci lattice, so the same
+  // directions are used for every eccentricity. orientation selects the moments:
+  //   radial : pointing away from the center
+  //   tangential : perpendicular to the radial direction, in the plane spanned by it and the z axis where possible
+  //   both : a radial and a tangential dipole at every position
+  // The dipoles are ordered by eccentricity, then direction, then orientation
+  inline std::vector<GeneratedDipole> generate_dipole_grid(const std::array<double, 3>& center,
+                                                           double inner_radius,
+                                                           std::size_t number_of_directions,
+                                                           double eccentricity_min,
+                                                           double eccentricity_max,
+                                                           std::size_t number_of_eccentricities,
+                                                           const std::string& orientation)
+  {
+    if(orientation != "radial" && orientation != "tangential" && orientation != "both") {
+      DUNE_THROW(Dune::Exception, "unknown dipole orientation " << orientation);
+    }
+    if(eccentricity_min < 0.0 || eccentricity_max >= 1.0 || eccentricity_min > eccentricity_max || number_of_eccentricities == 0) {
+      DUNE_THROW(Dune::RangeError, "eccentricities have to satisfy 0 <= min <= max < 1");
+    }
+    bool radial = orientation != "tangential";
+    bool tangential = orientation != "radial";
+
+    // a lattice on the unit sphere around the origin yields the directions
+    std::vector<std::array<double, 3>> directions = generate_fibonacci_electrodes(number_of_directions, {0.0, 0.0, 0.0}, 1.0);
+
+    std::vector<GeneratedDipole> dipoles;
+    dipoles.reserve(number_of_eccentricities * number_of_directions * (radial + tangential));
+    for(std::size_t e = 0; e < number_of_eccentricities; ++e) {
+      double eccentricity = number_of_eccentricities > 1
+        ? eccentricity_min + (eccentricity_max - eccentricity_min) * e / (number_of_eccentricities - 1)
+        : eccentricity_min;
+      for(const auto& direction : directions) {
+        GeneratedDipole dipole;
+        for(int i = 0; i < 3; ++i) {
+          dipole.position[i] = center[i] + eccentricity * inner_radius * direction[i];
+        }
+        if(radial) {
+          dipole.moment = direction;
+          dipoles.push_back(dipole);
+        }
+        if(tangential) {
+          // remove the radial part of the z axis, or of the x axis close to the poles
+          std::array<double, 3> axis = std::abs(direction[2]) < 0.9 ? std::array<double, 3>{0.0, 0.0, 1.0} : std::array<double, 3>{1.0, 0.0, 0.0};
+          double radial_part = axis[0] * direction[0] + axis[1] * direction[1] + axis[2] * direction[2];
+          double length = 0.0;
+          for(int i = 0; i < 3; ++i) {
+            dipole.moment[i] = axis[i] - radial_part * direction[i];
+            length += dipole.moment[i] * dipole.moment[i];
+          }
+          length = std::sqrt(length);
+          for(auto& entry : dipole.moment) {
+            entry /= length;
+          }
+          dipoles.push_back(dipole);
+        }
+      }
+    }
+    return dipoles;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_DIPOLE_GENERATOR_HH
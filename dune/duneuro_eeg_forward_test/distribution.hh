@@ -0,0 +1,74 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_DISTRIBUTION_HH
+#define DUNEURO_EEG_FORWARD_TEST_DISTRIBUTION_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <dune/duneuro_eeg_forward_test/dipole_errors.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // contiguous block [first, last) of size entries assigned to the given rank. The first size % number_of_ranks
+  // ranks receive one entry more than the others
+  inline std::pair<std::size_t, std::size_t> block_range(std::size_t size, int rank, int number_of_ranks)
+  {
+    std::size_t base = size / number_of_ranks;
+    std::size_t remainder = size % number_of_ranks;
+    std::size_t r = rank;
+    std::size_t first = r * base + std::min(r, remainder);
+    std::size_t last = first + base + (r < remainder ? 1 : 0);
+    return {first, last};
+  }
+
+  // collect the errors computed on every rank on the root rank. Each rank has filled the entries of its
+  // block_range in errors, after the call the errors vector on the root rank contains the results of all ranks
+  template<class Communication>
+  void gather_dipole_errors(const Communication& communication, std::vector<DipoleErrors>& errors, int root = 0)
+  {
+    constexpr int values_per_dipole = 5;
+    auto pack = [] (const DipoleErrors& e, double* out) {
+      out[0] = e.norm_analytical;
+      out[1] = e.norm_numerical;
+      out[2] = e.relative_error;
+      out[3] = e.mag;
+      out[4] = e.rdm;
+    };
+    auto unpack = [] (const double* in, DipoleErrors& e) {
+      e.norm_analytical = in[0];
+      e.norm_numerical = in[1];
+      e.relative_error = in[2];
+      e.mag = in[3];
+      e.rdm = in[4];
+    };
+
+    int number_of_ranks = communication.size();
+    auto local_range = block_range(errors.size(), communication.rank(), number_of_ranks);
+    std::vector<double> local_values(values_per_dipole * (local_range.second - local_range.first));
+    for(std::size_t i = local_range.first; i < local_range.second; ++i) {
+      pack(errors[i], local_values.data() + values_per_dipole * (i - local_range.first));
+    }
+
+    std::vector<int> counts(number_of_ranks);
+    std::vector<int> displacements(number_of_ranks);
+    for(int rank = 0; rank < number_of_ranks; ++rank) {
+      auto range = block_range(errors.size(), rank, number_of_ranks);
+      counts[rank] = values_per_dipole * (range.second - range.first);
+      displacements[rank] = values_per_dipole * range.first;
+    }
+
+    std::vector<double> all_values(values_per_dipole * errors.size());
+    communication.gatherv(local_values.data(), static_cast<int>(local_values.size()),
+                          all_values.data(), counts.data(), displacements.data(), root);
+
+    if(communication.rank() == root) {
+      for(std::size_t i = 0; i < errors.size(); ++i) {
+        unpack(all_values.data() + values_per_dipole * i, errors[i]);
+      }
+    }
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_DISTRIBUTION_HH
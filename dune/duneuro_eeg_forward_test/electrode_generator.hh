@@ -0,0 +1,34 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_ELECTRODE_GENERATOR_HH
+#define DUNEURO_EEG_FORWARD_TEST_ELECTRODE_GENERATOR_HH
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace duneuro_eeg_forward_test {
+
+  // number_of_electrodes quasi uniformly distributed points on the sphere with the given center and radius, placed on
+  // a Fibonacci lattice: point i has the height z_i = 1 - (2i + 1) / N and is rotated by the golden angle against
+  // point i - 1. Every point covers approximately the same area of the sphere
+  inline std::vector<std::array<double, 3>> generate_fibonacci_electrodes(std::size_t number_of_electrodes,
+                                                                          const std::array<double, 3>& center,
+                                                                          double radius)
+  {
+    const double golden_angle = M_PI * (3.0 - std::sqrt(5.0));
+    std::vector<std::array<double, 3>> electrodes;
+    electrodes.reserve(number_of_electrodes);
+    for(std::size_t i = 0; i < number_of_electrodes; ++i) {
+      double z = 1.0 - (2.0 * i + 1.0) / number_of_electrodes;
+      double ring_radius = std::sqrt(1.0 - z * z);
+      double angle = golden_angle * i;
+      electrodes.push_back({center[0] + radius * ring_radius * std::cos(angle),
+                            center[1] + radius * ring_radius * std::sin(angle),
+                            center[2] + radius * z});
+    }
+    return electrodes;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_ELECTRODE_GENERATOR_HH
@@ -0,0 +1,186 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_ELECTRODE_PROJECTION_CACHE_HH
+#define DUNEURO_EEG_FORWARD_TEST_ELECTRODE_PROJECTION_CACHE_HH
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/hash.hh>
+#include <dune/duneuro_eeg_forward_test/mapped_file.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // the cache consists of this header followed by number_of_entries projections. Every projection is stored as an
+  // ElectrodeProjectionCacheEntry followed by the index of the mesh vertex every electrode was projected onto
+  // (1 uint64 per electrode). A projection is valid for the mesh and the electrodes with the stored hashes
+  struct ElectrodeProjectionCacheHeader {
+    char magic[8];
+    std::uint64_t version;
+    std::uint64_t number_of_entries;
+  };
+
+  struct ElectrodeProjectionCacheEntry {
+    std::uint64_t mesh_hash;
+    std::uint64_t electrodes_hash;
+    std::uint64_t number_of_electrodes;
+  };
+
+  // a projection stored in the cache, with the hashes identifying it
+  struct ElectrodeProjection {
+    std::uint64_t mesh_hash = 0;
+    std::uint64_t electrodes_hash = 0;
+    std::vector<std::size_t> vertices;
+  };
+
+  constexpr char electrode_projection_cache_magic[8] = {'D', 'N', 'E', 'P', 'R', 'O', 'J', '\0'};
+  constexpr std::uint64_t electrode_projection_cache_version = 2;
+  // projections kept per file, e.g. for the levels of a convergence study. The oldest ones are dropped first
+  constexpr std::size_t electrode_projection_cache_entries = 16;
+
+  // hash of the geometry of a mesh, the labels do not influence the projection. It reads the whole mesh, so a
+  // cheaper identification of the mesh, e.g. the hash of the file it was read from, is preferable if available
+  inline std::uint64_t hash_mesh(const TetrahedralMesh& mesh)
+  {
+    Hash hash;
+    hash.add(mesh.nodes.size());
+    hash.add_bytes(mesh.nodes.data(), mesh.nodes.size() * sizeof(mesh.nodes[0]));
+    hash.add(mesh.elements.size());
+    hash.add_bytes(mesh.elements.data(), mesh.elements.size() * sizeof(mesh.elements[0]));
+    return hash.value();
+  }
+
+  inline std::uint64_t hash_electrodes(const std::vector<std::array<double, 3>>& electrodes)
+  {
+    Hash hash;
+    hash.add(electrodes.size());
+    hash.add_bytes(electrodes.data(), electrodes.size() * sizeof(electrodes[0]));
+    return hash.value();
+  }
+
+  // write the projections, replacing the file atomically as for write_mesh_cache
+  inline void write_electrode_projection_cache(const std::string& filename, const std::vector<ElectrodeProjection>& projections)
+  {
+    ElectrodeProjectionCacheHeader header;
+    std::memcpy(header.magic, electrode_projection_cache_magic, sizeof(header.magic));
+    header.version = electrode_projection_cache_version;
+    header.number_of_entries = projections.size();
+
+    std::string temporary_filename = filename + ".tmp" + std::to_string(::getpid());
+    {
+      std::ofstream out(temporary_filename, std::ios::binary);
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "could not open " << temporary_filename);
+      }
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      for(const auto& projection : projections) {
+        ElectrodeProjectionCacheEntry entry = {projection.mesh_hash, projection.electrodes_hash, projection.vertices.size()};
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        for(std::uint64_t vertex : projection.vertices) {
+          out.write(reinterpret_cast<const char*>(&vertex), sizeof(vertex));
+        }
+      }
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "error while writing " << temporary_filename);
+      }
+    }
+    if(std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+      std::remove(temporary_filename.c_str());
+      DUNE_THROW(Dune::IOError, "could not rename " << temporary_filename << " to " << filename);
+    }
+  }
+
+  // read the projections stored in the cache, in the order they were added. Returns no projections if the cache
+  // does not exist or is malformed
+  inline std::vector<ElectrodeProjection> read_electrode_projection_cache(const std::string& filename)
+  {
+    std::vector<ElectrodeProjection> projections;
+    struct stat file_status;
+    if(::stat(filename.c_str(), &file_status) != 0) {
+      return projections;
+    }
+
+    MappedFile file(filename);
+    ElectrodeProjectionCacheHeader header;
+    if(file.size() < sizeof(header)) {
+      return projections;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if(std::memcmp(header.magic, electrode_projection_cache_magic, sizeof(header.magic)) != 0
+       || header.version != electrode_projection_cache_version) {
+      return projections;
+    }
+
+    std::size_t offset = sizeof(header);
+    for(std::uint64_t i = 0; i < header.number_of_entries; ++i) {
+      ElectrodeProjectionCacheEntry entry;
+      if(file.size() - offset < sizeof(entry)) {
+        return {};
+      }
+      std::memcpy(&entry, file.data() + offset, sizeof(entry));
+      offset += sizeof(entry);
+      if((file.size() - offset) / sizeof(std::uint64_t) < entry.number_of_electrodes) {
+        return {};
+      }
+      ElectrodeProjection projection;
+      projection.mesh_hash = entry.mesh_hash;
+      projection.electrodes_hash = entry.electrodes_hash;
+      projection.vertices.resize(entry.number_of_electrodes);
+      for(auto& vertex : projection.vertices) {
+        std::uint64_t value;
+        std::memcpy(&value, file.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        vertex = value;
+      }
+      projections.push_back(std::move(projection));
+    }
+    if(offset != file.size()) {
+      return {};
+    }
+    return projections;
+  }
+
+  // load the projection of the electrodes onto the mesh identified by mesh_hash from cache_filename if it was
+  // stored for the same mesh and electrodes. Otherwise compute it using project(electrodes) and add the result to
+  // the cache, which keeps the projections of the last electrode_projection_cache_entries meshes
+  template<class Project>
+  std::vector<std::size_t> load_electrode_projection_with_cache(const std::string& cache_filename,
+                                                                std::uint64_t mesh_hash,
+                                                                const std::vector<std::array<double, 3>>& electrodes,
+                                                                Project&& project,
+                                                                bool& cache_hit)
+  {
+    std::uint64_t electrodes_hash = hash_electrodes(electrodes);
+    std::vector<ElectrodeProjection> projections = read_electrode_projection_cache(cache_filename);
+    for(auto& projection : projections) {
+      if(projection.mesh_hash == mesh_hash && projection.electrodes_hash == electrodes_hash
+         && projection.vertices.size() == electrodes.size()) {
+        cache_hit = true;
+        return std::move(projection.vertices);
+      }
+    }
+    cache_hit = false;
+    ElectrodeProjection projection;
+    projection.mesh_hash = mesh_hash;
+    projection.electrodes_hash = electrodes_hash;
+    projection.vertices = project(electrodes);
+    projections.push_back(projection);
+    if(projections.size() > electrode_projection_cache_entries) {
+      projections.erase(projections.begin(), projections.end() - electrode_projection_cache_entries);
+    }
+    write_electrode_projection_cache(cache_filename, projections);
+    return std::move(projection.vertices);
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_ELECTRODE_PROJECTION_CACHE_HH
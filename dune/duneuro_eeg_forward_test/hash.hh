@@ -0,0 +1,58 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_HASH_HH
+#define DUNEURO_EEG_FORWARD_TEST_HASH_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include <dune/duneuro_eeg_forward_test/mapped_file.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // incremental 64 bit FNV-1a hash, used to detect whether the inputs of a cached result have changed.
+  // Not suitable for anything security related
+  class Hash {
+  public:
+    Hash& add_bytes(const void* data, std::size_t size)
+    {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for(std::size_t i = 0; i < size; ++i) {
+        value_ ^= bytes[i];
+        value_ *= 1099511628211ull;
+      }
+      return *this;
+    }
+
+    template<class T>
+    Hash& add(const T& value)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be hashed bytewise");
+      return add_bytes(&value, sizeof(T));
+    }
+
+    Hash& add(const std::string& value)
+    {
+      add(value.size());
+      return add_bytes(value.data(), value.size());
+    }
+
+    std::uint64_t value() const
+    {
+      return value_;
+    }
+
+  private:
+    std::uint64_t value_ = 14695981039346656037ull;
+  };
+
+  // hash of the content of a file
+  inline std::uint64_t hash_file(const std::string& filename)
+  {
+    MappedFile file(filename);
+    return Hash().add_bytes(file.data(), file.size()).value();
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_HASH_HH
@@ -0,0 +1,236 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_HDF5_SERIES_WRITER_HH
+#define DUNEURO_EEG_FORWARD_TEST_HDF5_SERIES_WRITER_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if HAVE_HDF5
+#include <hdf5.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+#if HAVE_HDF5
+
+  // writer of the solutions of many dipoles on the same mesh into a single HDF5 file filename.h5, together with
+  // an XDMF descriptor filename.xmf that presents them as a temporal collection, e.g. for ParaView. The mesh is
+  // written once to /mesh/coordinates, /mesh/topology and /mesh/label. Every step adds the vertex potential
+  // /potential/<step> and the cell gradient /gradient/<step>, chunked into blocks of chunk_rows rows and deflate
+  // compressed with the given level if it is positive. The descriptor is written by close, which the destructor
+  // calls if necessary. Not thread safe, the serial HDF5 library must only be used by one thread at a time
+  class Hdf5SeriesWriter {
+  public:
+    Hdf5SeriesWriter(const TetrahedralMesh& mesh, std::string filename, int compression_level = 0, std::size_t chunk_rows = 1 << 14)
+      : number_of_nodes_(mesh.nodes.size())
+      , number_of_elements_(mesh.elements.size())
+      , filename_(std::move(filename))
+      , compression_level_(compression_level)
+      , chunk_rows_(std::max<std::size_t>(chunk_rows, 1))
+    {
+      if(compression_level_ > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0) {
+        DUNE_THROW(Dune::NotImplemented, "HDF5 compression requested, but the deflate filter is not available");
+      }
+      file_ = H5Fcreate((filename_ + ".h5").c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+      check(file_, "create " + filename_ + ".h5");
+      for(const char* group : {"/mesh", "/potential", "/gradient"}) {
+        hid_t id = H5Gcreate2(file_, group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        check(id, std::string("create group ") + group);
+        H5Gclose(id);
+      }
+
+      std::vector<std::int64_t> topology;
+      topology.reserve(4 * number_of_elements_);
+      for(const auto& element : mesh.elements) {
+        topology.insert(topology.end(), element.begin(), element.end());
+      }
+      std::vector<std::int32_t> labels(mesh.labels.begin(), mesh.labels.end());
+      write_dataset("/mesh/coordinates", H5T_NATIVE_DOUBLE, number_of_nodes_, 3, mesh.nodes.data(), false);
+      write_dataset("/mesh/topology", H5T_NATIVE_INT64, number_of_elements_, 4, topology.data(), false);
+      write_dataset("/mesh/label", H5T_NATIVE_INT32, number_of_elements_, 1, labels.data(), false);
+    }
+
+    Hdf5SeriesWriter(const Hdf5SeriesWriter&) = delete;
+    Hdf5SeriesWriter& operator=(const Hdf5SeriesWriter&) = delete;
+
+    ~Hdf5SeriesWriter()
+    {
+      try {
+        close();
+      }
+      catch(...) {
+      }
+    }
+
+    // add the solution of one dipole, step is its name in the file and its time in the collection
+    void add_step(std::size_t step, const std::vector<double>& potential, const std::vector<double>& gradients)
+    {
+      if(file_ < 0) {
+        DUNE_THROW(Dune::InvalidStateException, "step added to the closed file " << filename_ << ".h5");
+      }
+      if(potential.size() != number_of_nodes_ || gradients.size() != 3 * number_of_elements_) {
+        DUNE_THROW(Dune::RangeError, "step " << step << " does not match a mesh with " << number_of_nodes_
+                   << " vertices and " << number_of_elements_ << " elements");
+      }
+      std::string name = std::to_string(step);
+      write_dataset("/potential/" + name, H5T_NATIVE_DOUBLE, number_of_nodes_, 1, potential.data(), true);
+      write_dataset("/gradient/" + name, H5T_NATIVE_DOUBLE, number_of_elements_, 3, gradients.data(), true);
+      steps_.push_back(step);
+    }
+
+    // close the HDF5 file and write the XDMF descriptor
+    void close()
+    {
+      if(file_ < 0) {
+        return;
+      }
+      herr_t status = H5Fclose(file_);
+      file_ = -1;
+      check(status, "close " + filename_ + ".h5");
+      write_xdmf();
+    }
+
+  private:
+    static void check(std::int64_t status, const std::string& action)
+    {
+      if(status < 0) {
+        DUNE_THROW(Dune::IOError, "HDF5 could not " << action);
+      }
+    }
+
+    // dataset of rows x columns entries, chunked and compressed if requested
+    void write_dataset(const std::string& name, hid_t type, std::size_t rows, std::size_t columns, const void* data, bool chunked)
+    {
+      hsize_t dimensions[2] = {rows, columns};
+      hid_t space = H5Screate_simple(columns > 1 ? 2 : 1, dimensions, nullptr);
+      check(space, "create the data space of " + name);
+      hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+      if(properties < 0) {
+        H5Sclose(space);
+        check(properties, "create the properties of " + name);
+      }
+      if(chunked && rows > 0) {
+        hsize_t chunk[2] = {std::min<hsize_t>(chunk_rows_, rows), columns};
+        herr_t status = H5Pset_chunk(properties, columns > 1 ? 2 : 1, chunk);
+        if(status >= 0 && compression_level_ > 0) {
+          status = H5Pset_shuffle(properties);
+          if(status >= 0) {
+            status = H5Pset_deflate(properties, compression_level_);
+          }
+        }
+        if(status < 0) {
+          H5Pclose(properties);
+          H5Sclose(space);
+          check(status, "set the chunking and compression of " + name);
+        }
+      }
+      hid_t dataset = H5Dcreate2(file_, name.c_str(), type, space, H5P_DEFAULT, properties, H5P_DEFAULT);
+      H5Pclose(properties);
+      H5Sclose(space);
+      check(dataset, "create " + name);
+      herr_t status = H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+      H5Dclose(dataset);
+      check(status, "write " + name);
+    }
+
+    // the mesh is described once at the domain level, every step refers to it, so that the descriptor grows
+    // only by the solution of each step
+    void write_xdmf() const
+    {
+      // the descriptor refers to the HDF5 file relative to its own location
+      std::string h5_name = filename_.substr(filename_.find_last_of('/') + 1) + ".h5";
+      std::ofstream out(filename_ + ".xmf");
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "could not open " << filename_ << ".xmf");
+      }
+      auto data_item = [&] (const std::string& indent, const std::string& name, const std::string& dimensions,
+                            const char* number_type, int precision, const std::string& path) {
+        out << indent << "<DataItem";
+        if(!name.empty()) {
+          out << " Name=\"" << name << "\"";
+        }
+        out << " Dimensions=\"" << dimensions << "\" NumberType=\"" << number_type << "\" Precision=\"" << precision
+            << "\" Format=\"HDF\">" << h5_name << ":" << path << "</DataItem>\n";
+      };
+      auto reference = [&] (const std::string& name) {
+        out << "          <DataItem Reference=\"XML\">/Xdmf/Domain/DataItem[@Name=\"" << name << "\"]</DataItem>\n";
+      };
+      std::string nodes = std::to_string(number_of_nodes_);
+      std::string elements = std::to_string(number_of_elements_);
+
+      out << "<?xml version=\"1.0\" ?>\n";
+      out << "<Xdmf Version=\"3.0\">\n";
+      out << "  <Domain>\n";
+      data_item("    ", "topology", elements + " 4", "Int", 8, "/mesh/topology");
+      data_item("    ", "coordinates", nodes + " 3", "Float", 8, "/mesh/coordinates");
+      data_item("    ", "label", elements, "Int", 4, "/mesh/label");
+      out << "    <Grid Name=\"dipoles\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+      for(std::size_t step : steps_) {
+        std::string name = std::to_string(step);
+        out << "      <Grid Name=\"dipole_" << name << "\" GridType=\"Uniform\">\n";
+        out << "        <Time Value=\"" << name << "\"/>\n";
+        out << "        <Topology TopologyType=\"Tetrahedron\" NumberOfElements=\"" << elements << "\">\n";
+        reference("topology");
+        out << "        </Topology>\n";
+        out << "        <Geometry GeometryType=\"XYZ\">\n";
+        reference("coordinates");
+        out << "        </Geometry>\n";
+        out << "        <Attribute Name=\"label\" AttributeType=\"Scalar\" Center=\"Cell\">\n";
+        reference("label");
+        out << "        </Attribute>\n";
+        out << "        <Attribute Name=\"potential\" AttributeType=\"Scalar\" Center=\"Node\">\n";
+        data_item("          ", "", nodes, "Float", 8, "/potential/" + name);
+        out << "        </Attribute>\n";
+        out << "        <Attribute Name=\"gradient\" AttributeType=\"Vector\" Center=\"Cell\">\n";
+        data_item("          ", "", elements + " 3", "Float", 8, "/gradient/" + name);
+        out << "        </Attribute>\n";
+        out << "      </Grid>\n";
+      }
+      out << "    </Grid>\n";
+      out << "  </Domain>\n";
+      out << "</Xdmf>\n";
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "error while writing " << filename_ << ".xmf");
+      }
+    }
+
+    std::size_t number_of_nodes_;
+    std::size_t number_of_elements_;
+    std::string filename_;
+    int compression_level_;
+    std::size_t chunk_rows_;
+    hid_t file_ = -1;
+    std::vector<std::size_t> steps_;
+  };
+
+#else
+
+  // without HDF5 the writer can not be created, the interface is that of the implementation above
+  class Hdf5SeriesWriter {
+  public:
+    Hdf5SeriesWriter(const TetrahedralMesh&, std::string, int = 0, std::size_t = 1 << 14)
+    {
+      DUNE_THROW(Dune::NotImplemented, "HDF5 output requested, but HDF5 was not found when configuring");
+    }
+
+    void add_step(std::size_t, const std::vector<double>&, const std::vector<double>&)
+    {
+    }
+
+    void close()
+    {
+    }
+  };
+
+#endif
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_HDF5_SERIES_WRITER_HH
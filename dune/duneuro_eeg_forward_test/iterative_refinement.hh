@@ -0,0 +1,78 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_ITERATIVE_REFINEMENT_HH
+#define DUNEURO_EEG_FORWARD_TEST_ITERATIVE_REFINEMENT_HH
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/conjugate_gradient.hh>
+#include <dune/duneuro_eeg_forward_test/sparse_matrix.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // solve A x = b to the accuracy of double precision while doing the CG iterations in single precision.
+  // Every refinement step computes the residual r = b - A x in double precision and solves A d = r approximately
+  // by CG on a float copy of the matrix, reducing the residual by inner_reduction, which has to be reachable in
+  // single precision. The residual is scaled to unit norm before the conversion to float. The iteration stops
+  // once |b - A x| <= reduction |b| as for conjugate_gradient. Since the iterations only read the float matrix,
+  // they move half the data of double precision iterations
+  inline SolverResult mixed_precision_refinement(const SparseMatrix<double>& matrix,
+                                                 const SparseMatrix<float>& float_matrix,
+                                                 const std::vector<float>& float_preconditioner,
+                                                 const std::vector<double>& b,
+                                                 std::vector<double>& x,
+                                                 double reduction,
+                                                 double inner_reduction,
+                                                 std::size_t max_iterations,
+                                                 std::size_t max_refinements = 50)
+  {
+    std::size_t size = matrix.size;
+    if(b.size() != size || x.size() != size) {
+      DUNE_THROW(Dune::RangeError, "matrix of size " << size << " does not match vectors of size " << b.size() << " and " << x.size());
+    }
+
+    SolverResult result;
+    double norm_b = std::sqrt(dot(b, b));
+    if(norm_b == 0.0) {
+      x.assign(size, 0.0);
+      result.converged = true;
+      return result;
+    }
+    double target = reduction * norm_b;
+
+    std::vector<double> r(size);
+    std::vector<float> float_r(size), float_d(size);
+    while(true) {
+      matrix.multiply(x.data(), r.data());
+      for(std::size_t i = 0; i < size; ++i) {
+        r[i] = b[i] - r[i];
+      }
+      double norm_r = std::sqrt(dot(r, r));
+      result.reduction = norm_r / norm_b;
+      if(norm_r <= target) {
+        result.converged = true;
+        break;
+      }
+      if(result.refinements == max_refinements || result.iterations >= max_iterations) {
+        break;
+      }
+
+      for(std::size_t i = 0; i < size; ++i) {
+        float_r[i] = static_cast<float>(r[i] / norm_r);
+      }
+      float_d.assign(size, 0.0f);
+      SolverResult inner = conjugate_gradient(float_matrix, float_preconditioner, float_r, float_d, inner_reduction, max_iterations - result.iterations);
+      result.iterations += inner.iterations;
+      ++result.refinements;
+      for(std::size_t i = 0; i < size; ++i) {
+        x[i] += norm_r * float_d[i];
+      }
+    }
+    return result;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_ITERATIVE_REFINEMENT_HH
@@ -0,0 +1,115 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_KD_TREE_HH
+#define DUNEURO_EEG_FORWARD_TEST_KD_TREE_HH
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // k-d tree for nearest neighbor queries among a fixed set of points in 3d. The tree is implicit: the point
+  // indices are permuted such that every range [begin, end) is split at its middle element along the axis
+  // depth % 3, so no nodes are stored. Building costs O(M log M), a query O(log M) for well distributed points.
+  // The points are copied in tree order, queries are thread safe
+  class KdTree {
+  public:
+    KdTree() = default;
+
+    explicit KdTree(const std::vector<std::array<double, 3>>& points)
+      : indices_(points.size())
+    {
+      std::iota(indices_.begin(), indices_.end(), std::size_t(0));
+      build(points, 0, indices_.size(), 0);
+      points_.reserve(points.size());
+      for(std::size_t index : indices_) {
+        points_.push_back(points[index]);
+      }
+    }
+
+    std::size_t size() const
+    {
+      return points_.size();
+    }
+
+    // index of the point closest to position, among equally close points the one found first
+    std::size_t nearest(const std::array<double, 3>& position) const
+    {
+      if(points_.empty()) {
+        DUNE_THROW(Dune::RangeError, "nearest neighbor query in an empty k-d tree");
+      }
+      std::size_t best = 0;
+      double best_distance = std::numeric_limits<double>::max();
+      search(position, 0, points_.size(), 0, best, best_distance);
+      return indices_[best];
+    }
+
+  private:
+    static constexpr std::size_t leaf_size = 8;
+
+    void build(const std::vector<std::array<double, 3>>& points, std::size_t begin, std::size_t end, int depth)
+    {
+      if(end - begin <= leaf_size) {
+        return;
+      }
+      int axis = depth % 3;
+      std::size_t middle = begin + (end - begin) / 2;
+      std::nth_element(indices_.begin() + begin, indices_.begin() + middle, indices_.begin() + end,
+                       [&points, axis] (std::size_t a, std::size_t b) { return points[a][axis] < points[b][axis]; });
+      build(points, begin, middle, depth + 1);
+      build(points, middle + 1, end, depth + 1);
+    }
+
+    void search(const std::array<double, 3>& position, std::size_t begin, std::size_t end, int depth,
+                std::size_t& best, double& best_distance) const
+    {
+      if(end - begin <= leaf_size) {
+        for(std::size_t i = begin; i < end; ++i) {
+          check(position, i, best, best_distance);
+        }
+        return;
+      }
+      int axis = depth % 3;
+      std::size_t middle = begin + (end - begin) / 2;
+      check(position, middle, best, best_distance);
+      double offset = position[axis] - points_[middle][axis];
+      // descend into the half containing the position first, the other half can only contain a closer point
+      // if the splitting plane is closer than the best point found so far
+      if(offset < 0.0) {
+        search(position, begin, middle, depth + 1, best, best_distance);
+        if(offset * offset < best_distance) {
+          search(position, middle + 1, end, depth + 1, best, best_distance);
+        }
+      }
+      else {
+        search(position, middle + 1, end, depth + 1, best, best_distance);
+        if(offset * offset < best_distance) {
+          search(position, begin, middle, depth + 1, best, best_distance);
+        }
+      }
+    }
+
+    void check(const std::array<double, 3>& position, std::size_t i, std::size_t& best, double& best_distance) const
+    {
+      double distance = 0.0;
+      for(int c = 0; c < 3; ++c) {
+        double difference = points_[i][c] - position[c];
+        distance += difference * difference;
+      }
+      if(distance < best_distance) {
+        best_distance = distance;
+        best = i;
+      }
+    }
+
+    std::vector<std::size_t> indices_;
+    std::vector<std::array<double, 3>> points_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_KD_TREE_HH
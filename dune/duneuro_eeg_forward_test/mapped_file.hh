@@ -0,0 +1,76 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_MAPPED_FILE_HH
+#define DUNEURO_EEG_FORWARD_TEST_MAPPED_FILE_HH
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // read only memory mapping of a whole file
+  class MappedFile {
+  public:
+    explicit MappedFile(const std::string& filename)
+    {
+      int file_descriptor = ::open(filename.c_str(), O_RDONLY);
+      if(file_descriptor < 0) {
+        DUNE_THROW(Dune::IOError, "could not open " << filename);
+      }
+      struct stat file_status;
+      if(::fstat(file_descriptor, &file_status) != 0) {
+        ::close(file_descriptor);
+        DUNE_THROW(Dune::IOError, "could not stat " << filename);
+      }
+      size_ = file_status.st_size;
+      if(size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if(address == MAP_FAILED) {
+          ::close(file_descriptor);
+          DUNE_THROW(Dune::IOError, "could not map " << filename);
+        }
+        data_ = static_cast<const char*>(address);
+      }
+      ::close(file_descriptor);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr))
+      , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    ~MappedFile()
+    {
+      if(data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+      }
+    }
+
+    const char* data() const
+    {
+      return data_;
+    }
+
+    std::size_t size() const
+    {
+      return size_;
+    }
+
+  private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_MAPPED_FILE_HH
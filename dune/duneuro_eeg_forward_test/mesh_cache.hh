@@ -0,0 +1,192 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_MESH_CACHE_HH
+#define DUNEURO_EEG_FORWARD_TEST_MESH_CACHE_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/hash.hh>
+#include <dune/duneuro_eeg_forward_test/mapped_file.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // the binary cache consists of this header followed by the node coordinates (3 doubles per node),
+  // the element vertex indices (4 uint32 per element) and the labels (1 uint64 per element).
+  // The source fields identify the file the cache was created from
+  struct MeshCacheHeader {
+    char magic[8];
+    std::uint64_t version;
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    std::int64_t source_mtime_ns;
+    std::uint64_t number_of_nodes;
+    std::uint64_t number_of_elements;
+  };
+
+  constexpr char mesh_cache_magic[8] = {'D', 'N', 'M', 'E', 'S', 'H', 'C', '\0'};
+  constexpr std::uint64_t mesh_cache_version = 2;
+
+  // identification of a mesh file by its size, modification time and the hash_file of its content
+  struct MeshSource {
+    std::uint64_t hash = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+  };
+
+  // size and modification time of filename, the hash is left at 0
+  inline MeshSource mesh_source_status(const std::string& filename)
+  {
+    struct stat file_status;
+    if(::stat(filename.c_str(), &file_status) != 0) {
+      DUNE_THROW(Dune::IOError, "could not stat " << filename);
+    }
+    MeshSource source;
+    source.size = file_status.st_size;
+    source.mtime_ns = static_cast<std::int64_t>(file_status.st_mtim.tv_sec) * 1000000000 + file_status.st_mtim.tv_nsec;
+    return source;
+  }
+
+  inline std::size_t mesh_cache_size(std::uint64_t number_of_nodes, std::uint64_t number_of_elements)
+  {
+    return sizeof(MeshCacheHeader)
+      + number_of_nodes * 3 * sizeof(double)
+      + number_of_elements * 4 * sizeof(std::uint32_t)
+      + number_of_elements * sizeof(std::uint64_t);
+  }
+
+  // write the mesh to a binary cache file, tagged with the file it was created from.
+  // The file is written under a temporary name and then renamed, so that concurrent readers, e.g. other
+  // MPI ranks, never see a partially written cache
+  inline void write_mesh_cache(const std::string& filename, const MeshSource& source, const TetrahedralMesh& mesh)
+  {
+    MeshCacheHeader header;
+    std::memcpy(header.magic, mesh_cache_magic, sizeof(header.magic));
+    header.version = mesh_cache_version;
+    header.source_hash = source.hash;
+    header.source_size = source.size;
+    header.source_mtime_ns = source.mtime_ns;
+    header.number_of_nodes = mesh.nodes.size();
+    header.number_of_elements = mesh.elements.size();
+
+    std::string temporary_filename = filename + ".tmp" + std::to_string(::getpid());
+    {
+      std::ofstream out(temporary_filename, std::ios::binary);
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "could not open " << temporary_filename);
+      }
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(mesh.nodes.data()), mesh.nodes.size() * 3 * sizeof(double));
+      for(const auto& element : mesh.elements) {
+        std::uint32_t vertices[4] = {element[0], element[1], element[2], element[3]};
+        out.write(reinterpret_cast<const char*>(vertices), sizeof(vertices));
+      }
+      for(std::uint64_t label : mesh.labels) {
+        out.write(reinterpret_cast<const char*>(&label), sizeof(label));
+      }
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "error while writing " << temporary_filename);
+      }
+    }
+    if(std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+      std::remove(temporary_filename.c_str());
+      DUNE_THROW(Dune::IOError, "could not rename " << temporary_filename << " to " << filename);
+    }
+  }
+
+  // read the binary cache into mesh if it was created from a file accepted by matches(header). Returns false,
+  // leaving mesh untouched, if the cache does not exist, is malformed or is not accepted
+  template<class Matches>
+  bool read_mesh_cache(const std::string& filename, Matches&& matches, TetrahedralMesh& mesh)
+  {
+    struct stat file_status;
+    if(::stat(filename.c_str(), &file_status) != 0) {
+      return false;
+    }
+
+    MappedFile file(filename);
+    MeshCacheHeader header;
+    if(file.size() < sizeof(header)) {
+      return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if(std::memcmp(header.magic, mesh_cache_magic, sizeof(header.magic)) != 0
+       || header.version != mesh_cache_version
+       || file.size() != mesh_cache_size(header.number_of_nodes, header.number_of_elements)
+       || !matches(header)) {
+      return false;
+    }
+
+    const char* position = file.data() + sizeof(header);
+    mesh.nodes.resize(header.number_of_nodes);
+    std::memcpy(mesh.nodes.data(), position, header.number_of_nodes * 3 * sizeof(double));
+    position += header.number_of_nodes * 3 * sizeof(double);
+
+    mesh.elements.resize(header.number_of_elements);
+    for(auto& element : mesh.elements) {
+      std::uint32_t vertices[4];
+      std::memcpy(vertices, position, sizeof(vertices));
+      position += sizeof(vertices);
+      element = {vertices[0], vertices[1], vertices[2], vertices[3]};
+    }
+
+    mesh.labels.resize(header.number_of_elements);
+    for(auto& label : mesh.labels) {
+      std::uint64_t value;
+      std::memcpy(&value, position, sizeof(value));
+      position += sizeof(value);
+      label = value;
+    }
+    return true;
+  }
+
+  // load the mesh from cache_filename if it was created from the current content of mesh_filename. Otherwise parse
+  // mesh_filename using parse(mesh_filename) and store the result in the cache. mesh_hash is set to the hash_file of
+  // mesh_filename.
+  // A cache created from a file with the same size and modification time is used without reading mesh_filename.
+  // Otherwise the file is hashed, and if only its modification time changed, e.g. by copying it, the cache is still
+  // used and rewritten with the new time. A modification that keeps both size and modification time is not detected
+  template<class Parse>
+  TetrahedralMesh load_mesh_with_cache(const std::string& mesh_filename, const std::string& cache_filename, Parse&& parse,
+                                       bool& cache_hit, std::uint64_t& mesh_hash)
+  {
+    MeshSource source = mesh_source_status(mesh_filename);
+    TetrahedralMesh mesh;
+    cache_hit = read_mesh_cache(cache_filename, [&source] (const MeshCacheHeader& header) {
+        if(header.source_size != source.size || header.source_mtime_ns != source.mtime_ns) {
+          return false;
+        }
+        source.hash = header.source_hash;
+        return true;
+      }, mesh);
+    if(!cache_hit) {
+      source.hash = hash_file(mesh_filename);
+      cache_hit = read_mesh_cache(cache_filename, [&source] (const MeshCacheHeader& header) {
+          return header.source_size == source.size && header.source_hash == source.hash;
+        }, mesh);
+      if(!cache_hit) {
+        mesh = parse(mesh_filename);
+      }
+      write_mesh_cache(cache_filename, source, mesh);
+    }
+    mesh_hash = source.hash;
+    return mesh;
+  }
+
+  template<class Parse>
+  TetrahedralMesh load_mesh_with_cache(const std::string& mesh_filename, const std::string& cache_filename, Parse&& parse, bool& cache_hit)
+  {
+    std::uint64_t mesh_hash;
+    return load_mesh_with_cache(mesh_filename, cache_filename, std::forward<Parse>(parse), cache_hit, mesh_hash);
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_MESH_CACHE_HH
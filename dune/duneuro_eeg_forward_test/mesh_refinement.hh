@@ -0,0 +1,88 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_MESH_REFINEMENT_HH
+#define DUNEURO_EEG_FORWARD_TEST_MESH_REFINEMENT_HH
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  namespace refinement_detail {
+    inline double orientation(const TetrahedralMesh& mesh, const std::array<unsigned int, 4>& element)
+    {
+      const auto& p0 = mesh.nodes[element[0]];
+      double j[3][3];
+      for(int i = 0; i < 3; ++i) {
+        for(int c = 0; c < 3; ++c) {
+          j[i][c] = mesh.nodes[element[c + 1]][i] - p0[i];
+        }
+      }
+      return j[0][0] * (j[1][1] * j[2][2] - j[1][2] * j[2][1])
+           - j[0][1] * (j[1][0] * j[2][2] - j[1][2] * j[2][0])
+           + j[0][2] * (j[1][0] * j[2][1] - j[1][1] * j[2][0]);
+    }
+  } // namespace refinement_detail
+
+  // uniform red refinement, every tetrahedron is split into 8 children by the edge midpoints following Bey,
+  // "Tetrahedral grid refinement", 1995. Children inherit the label of their parent and the orientation of their
+  // parent. The nodes of the coarse mesh keep their indices, the midpoints are appended. Curved interfaces are not
+  // approximated better by the refined mesh, only the resolution of the potential increases
+  inline TetrahedralMesh refine_uniformly(const TetrahedralMesh& mesh)
+  {
+    TetrahedralMesh refined;
+    refined.nodes = mesh.nodes;
+    refined.elements.reserve(8 * mesh.elements.size());
+    refined.labels.reserve(8 * mesh.labels.size());
+
+    std::unordered_map<std::uint64_t, unsigned int> midpoints;
+    midpoints.reserve(7 * mesh.nodes.size());
+    auto midpoint = [&] (unsigned int a, unsigned int b) {
+      if(a > b) {
+        std::swap(a, b);
+      }
+      std::uint64_t key = (static_cast<std::uint64_t>(a) << 32) | b;
+      auto inserted = midpoints.emplace(key, static_cast<unsigned int>(refined.nodes.size()));
+      if(inserted.second) {
+        const auto& pa = mesh.nodes[a];
+        const auto& pb = mesh.nodes[b];
+        refined.nodes.push_back({0.5 * (pa[0] + pb[0]), 0.5 * (pa[1] + pb[1]), 0.5 * (pa[2] + pb[2])});
+      }
+      return inserted.first->second;
+    };
+
+    for(std::size_t e = 0; e < mesh.elements.size(); ++e) {
+      const auto& x = mesh.elements[e];
+      unsigned int x01 = midpoint(x[0], x[1]);
+      unsigned int x02 = midpoint(x[0], x[2]);
+      unsigned int x03 = midpoint(x[0], x[3]);
+      unsigned int x12 = midpoint(x[1], x[2]);
+      unsigned int x13 = midpoint(x[1], x[3]);
+      unsigned int x23 = midpoint(x[2], x[3]);
+      std::array<std::array<unsigned int, 4>, 8> children = {{
+        {x[0], x01, x02, x03},
+        {x01, x[1], x12, x13},
+        {x02, x12, x[2], x23},
+        {x03, x13, x23, x[3]},
+        {x01, x02, x03, x13},
+        {x01, x02, x12, x13},
+        {x02, x03, x13, x23},
+        {x02, x12, x13, x23}
+      }};
+      bool positive = refinement_detail::orientation(mesh, x) > 0.0;
+      for(auto& child : children) {
+        if((refinement_detail::orientation(refined, child) > 0.0) != positive) {
+          std::swap(child[2], child[3]);
+        }
+        refined.elements.push_back(child);
+        refined.labels.push_back(mesh.labels[e]);
+      }
+    }
+    return refined;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_MESH_REFINEMENT_HH
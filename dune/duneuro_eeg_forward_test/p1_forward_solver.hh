@@ -0,0 +1,320 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_P1_FORWARD_SOLVER_HH
+#define DUNEURO_EEG_FORWARD_TEST_P1_FORWARD_SOLVER_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/conjugate_gradient.hh>
+#include <dune/duneuro_eeg_forward_test/iterative_refinement.hh>
+#include <dune/duneuro_eeg_forward_test/kd_tree.hh>
+#include <dune/duneuro_eeg_forward_test/parallel_for.hh>
+#include <dune/duneuro_eeg_forward_test/sparse_matrix.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+#include <dune/duneuro_eeg_forward_test/warm_start.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // gradients of the barycentric coordinates and volume of a tetrahedron
+  struct TetrahedronGeometry {
+    std::array<std::array<double, 3>, 4> gradients;
+    std::array<std::array<double, 3>, 3> inverse_jacobian;
+    double volume;
+  };
+
+  inline TetrahedronGeometry tetrahedron_geometry(const TetrahedralMesh& mesh, std::size_t element)
+  {
+    const auto& vertices = mesh.elements[element];
+    const auto& p0 = mesh.nodes[vertices[0]];
+    // the columns of the jacobian are the edges starting at vertex 0
+    double j[3][3];
+    for(int i = 0; i < 3; ++i) {
+      for(int c = 0; c < 3; ++c) {
+        j[i][c] = mesh.nodes[vertices[c + 1]][i] - p0[i];
+      }
+    }
+    double determinant = j[0][0] * (j[1][1] * j[2][2] - j[1][2] * j[2][1])
+                       - j[0][1] * (j[1][0] * j[2][2] - j[1][2] * j[2][0])
+                       + j[0][2] * (j[1][0] * j[2][1] - j[1][1] * j[2][0]);
+    if(determinant == 0.0) {
+      DUNE_THROW(Dune::MathError, "element " << element << " is degenerate");
+    }
+
+    TetrahedronGeometry geometry;
+    auto& inverse = geometry.inverse_jacobian;
+    inverse[0] = {j[1][1] * j[2][2] - j[1][2] * j[2][1], j[0][2] * j[2][1] - j[0][1] * j[2][2], j[0][1] * j[1][2] - j[0][2] * j[1][1]};
+    inverse[1] = {j[1][2] * j[2][0] - j[1][0] * j[2][2], j[0][0] * j[2][2] - j[0][2] * j[2][0], j[0][2] * j[1][0] - j[0][0] * j[1][2]};
+    inverse[2] = {j[1][0] * j[2][1] - j[1][1] * j[2][0], j[0][1] * j[2][0] - j[0][0] * j[2][1], j[0][0] * j[1][1] - j[0][1] * j[1][0]};
+    for(auto& row : inverse) {
+      for(auto& entry : row) {
+        entry /= determinant;
+      }
+    }
+
+    // the rows of the inverse jacobian are the gradients of the barycentric coordinates 1, 2 and 3
+    for(int i = 0; i < 3; ++i) {
+      geometry.gradients[i + 1] = inverse[i];
+      geometry.gradients[0][i] = -(inverse[0][i] + inverse[1][i] + inverse[2][i]);
+    }
+    geometry.volume = std::abs(determinant) / 6.0;
+    return geometry;
+  }
+
+  // stiffness matrix of the P1 finite element discretization of -div(sigma grad u) with homogeneous Neumann
+  // boundary conditions. The conductivity of an element is conductivities[label]
+  inline SparseMatrix<double> assemble_stiffness_matrix(const TetrahedralMesh& mesh, const std::vector<double>& conductivities)
+  {
+    SparseMatrix<double> matrix = make_element_pattern<double>(mesh.nodes.size(), mesh.elements);
+    for(std::size_t element = 0; element < mesh.elements.size(); ++element) {
+      if(mesh.labels[element] >= conductivities.size()) {
+        DUNE_THROW(Dune::RangeError, "no conductivity given for label " << mesh.labels[element] << " of element " << element);
+      }
+      double sigma = conductivities[mesh.labels[element]];
+      TetrahedronGeometry geometry = tetrahedron_geometry(mesh, element);
+      const auto& vertices = mesh.elements[element];
+      for(int a = 0; a < 4; ++a) {
+        for(int b = 0; b < 4; ++b) {
+          const auto& ga = geometry.gradients[a];
+          const auto& gb = geometry.gradients[b];
+          matrix.entry(vertices[a], vertices[b]) += sigma * geometry.volume * (ga[0] * gb[0] + ga[1] * gb[1] + ga[2] * gb[2]);
+        }
+      }
+    }
+    return matrix;
+  }
+
+  // gradient of a P1 function on every element, stored contiguously in gradients, i.e. the gradient on element e
+  // is gradients[3 * e + i] for i = 0, 1, 2. The buffer is only resized if it does not have this size already, so
+  // that it can be reused for many solutions. The elements are distributed over number_of_threads threads in chunks,
+  // every thread writes a disjoint part of the buffer
+  inline void compute_cell_gradients(const TetrahedralMesh& mesh,
+                                     const std::vector<double>& solution,
+                                     std::vector<double>& gradients,
+                                     std::size_t number_of_threads = 1)
+  {
+    if(solution.size() != mesh.nodes.size()) {
+      DUNE_THROW(Dune::RangeError, "solution of size " << solution.size() << " does not match a mesh with " << mesh.nodes.size() << " vertices");
+    }
+    gradients.resize(3 * mesh.elements.size());
+    parallel_for(mesh.elements.size(), number_of_threads, 1 << 12, [&] (std::size_t begin, std::size_t end) {
+      for(std::size_t element = begin; element < end; ++element) {
+        TetrahedronGeometry geometry = tetrahedron_geometry(mesh, element);
+        double gradient[3] = {0.0, 0.0, 0.0};
+        for(int a = 0; a < 4; ++a) {
+          double value = solution[mesh.elements[element][a]];
+          for(int i = 0; i < 3; ++i) {
+            gradient[i] += value * geometry.gradients[a][i];
+          }
+        }
+        std::copy(gradient, gradient + 3, gradients.begin() + 3 * element);
+      }
+    });
+  }
+
+  inline std::vector<double> compute_cell_gradients(const TetrahedralMesh& mesh, const std::vector<double>& solution, std::size_t number_of_threads = 1)
+  {
+    std::vector<double> gradients;
+    compute_cell_gradients(mesh, solution, gradients, number_of_threads);
+    return gradients;
+  }
+
+  // EEG forward solver working directly on the tetrahedral mesh, used where the solve itself has to be controlled,
+  // e.g. to pass an initial guess. The potential is discretized with P1 elements, the dipole is modeled by the
+  // partial integration approach, i.e. the right hand side is (q . grad phi_i)(x_0), and the linear system is
+  // solved by Jacobi preconditioned CG. Electrodes are evaluated at the closest mesh vertex, as the driver does for
+  // electrodes.type=closest_subentity_center with codims=3
+  class P1ForwardSolver {
+  public:
+    P1ForwardSolver(TetrahedralMesh mesh, const std::vector<double>& conductivities)
+      : mesh_(std::move(mesh))
+      , matrix_(assemble_stiffness_matrix(mesh_, conductivities))
+      , preconditioner_(inverse_diagonal(matrix_))
+    {
+    }
+
+    // solve uses mixed_precision_refinement from now on, with CG iterations in single precision that reduce the
+    // residual by inner_reduction per refinement step
+    void enable_mixed_precision(double inner_reduction)
+    {
+      float_matrix_ = matrix_.convert<float>();
+      float_preconditioner_ = inverse_diagonal(float_matrix_);
+      inner_reduction_ = inner_reduction;
+      mixed_precision_ = true;
+    }
+
+    // index of the closest mesh vertex of every electrode. The vertices are found with a k-d tree over the mesh
+    // nodes, built on the first call, which keeps projecting a dense montage cheap compared to a linear search
+    // over all nodes per electrode
+    std::vector<std::size_t> project_electrodes(const std::vector<std::array<double, 3>>& electrodes)
+    {
+      if(node_tree_.size() != mesh_.nodes.size()) {
+        node_tree_ = KdTree(mesh_.nodes);
+      }
+      std::vector<std::size_t> vertices;
+      vertices.reserve(electrodes.size());
+      for(const auto& electrode : electrodes) {
+        vertices.push_back(node_tree_.nearest(electrode));
+      }
+      return vertices;
+    }
+
+    void set_electrodes(const std::vector<std::array<double, 3>>& electrodes)
+    {
+      set_electrode_vertices(project_electrodes(electrodes));
+    }
+
+    // electrodes given by the vertices they are projected onto, e.g. a projection loaded from a cache
+    void set_electrode_vertices(std::vector<std::size_t> vertices)
+    {
+      for(std::size_t vertex : vertices) {
+        if(vertex >= mesh_.nodes.size()) {
+          DUNE_THROW(Dune::RangeError, "electrode vertex " << vertex << " is not a vertex of a mesh with " << mesh_.nodes.size() << " vertices");
+        }
+      }
+      electrode_vertices_ = std::move(vertices);
+    }
+
+    // index of an element containing position
+    std::size_t locate(const std::array<double, 3>& position) const
+    {
+      constexpr double tolerance = 1e-10;
+      for(std::size_t element = 0; element < mesh_.elements.size(); ++element) {
+        if(contains(element, position, tolerance)) {
+          return element;
+        }
+      }
+      DUNE_THROW(Dune::RangeError, "position (" << position[0] << ", " << position[1] << ", " << position[2] << ") is outside of the mesh");
+    }
+
+    std::vector<double> right_hand_side(const std::array<double, 3>& position, const std::array<double, 3>& moment) const
+    {
+      std::size_t element = locate(position);
+      TetrahedronGeometry geometry = tetrahedron_geometry(mesh_, element);
+      std::vector<double> rhs(matrix_.size, 0.0);
+      for(int a = 0; a < 4; ++a) {
+        const auto& gradient = geometry.gradients[a];
+        rhs[mesh_.elements[element][a]] += moment[0] * gradient[0] + moment[1] * gradient[1] + moment[2] * gradient[2];
+      }
+      return rhs;
+    }
+
+    // solve for the potential of the dipole, starting from the initial guess of warm_start, to which the solution
+    // is added afterwards
+    SolverResult solve(const std::array<double, 3>& position,
+                       const std::array<double, 3>& moment,
+                       std::vector<double>& solution,
+                       WarmStart& warm_start,
+                       double reduction,
+                       std::size_t max_iterations) const
+    {
+      std::vector<double> rhs = right_hand_side(position, moment);
+      warm_start.initial_guess(rhs, solution);
+      SolverResult result = mixed_precision_
+        ? mixed_precision_refinement(matrix_, float_matrix_, float_preconditioner_, rhs, solution, reduction, inner_reduction_, max_iterations)
+        : conjugate_gradient(matrix_, preconditioner_, rhs, solution, reduction, max_iterations);
+      warm_start.add_solution(matrix_, solution);
+      return result;
+    }
+
+    // solve for the potentials of several dipoles at once using block_conjugate_gradient, starting from zero.
+    // The solutions are stored interleaved, solutions[i * positions.size() + j] belongs to vertex i and dipole j
+    SolverResult solve_block(const std::vector<std::array<double, 3>>& positions,
+                             const std::vector<std::array<double, 3>>& moments,
+                             std::vector<double>& solutions,
+                             double reduction,
+                             std::size_t max_iterations) const
+    {
+      std::size_t block_size = positions.size();
+      std::vector<double> rhs(matrix_.size * block_size, 0.0);
+      for(std::size_t j = 0; j < block_size; ++j) {
+        std::vector<double> column = right_hand_side(positions[j], moments[j]);
+        for(std::size_t i = 0; i < matrix_.size; ++i) {
+          rhs[i * block_size + j] = column[i];
+        }
+      }
+      solutions.assign(rhs.size(), 0.0);
+      return block_conjugate_gradient(matrix_, preconditioner_, rhs, solutions, block_size, reduction, max_iterations);
+    }
+
+    // potentials at the electrodes of dipole j of a block solution
+    std::vector<double> evaluate_at_electrodes(const std::vector<double>& solutions, std::size_t block_size, std::size_t j) const
+    {
+      std::vector<double> potentials;
+      potentials.reserve(electrode_vertices_.size());
+      for(std::size_t vertex : electrode_vertices_) {
+        potentials.push_back(solutions[vertex * block_size + j]);
+      }
+      return potentials;
+    }
+
+    std::vector<double> evaluate_at_electrodes(const std::vector<double>& solution) const
+    {
+      std::vector<double> potentials;
+      potentials.reserve(electrode_vertices_.size());
+      for(std::size_t vertex : electrode_vertices_) {
+        potentials.push_back(solution[vertex]);
+      }
+      return potentials;
+    }
+
+    const TetrahedralMesh& mesh() const
+    {
+      return mesh_;
+    }
+
+    const SparseMatrix<double>& matrix() const
+    {
+      return matrix_;
+    }
+
+  private:
+    bool contains(std::size_t element, const std::array<double, 3>& position, double tolerance) const
+    {
+      const auto& vertices = mesh_.elements[element];
+      // cheap bounding box test before computing barycentric coordinates
+      for(int i = 0; i < 3; ++i) {
+        double lower = mesh_.nodes[vertices[0]][i];
+        double upper = lower;
+        for(int v = 1; v < 4; ++v) {
+          lower = std::min(lower, mesh_.nodes[vertices[v]][i]);
+          upper = std::max(upper, mesh_.nodes[vertices[v]][i]);
+        }
+        if(position[i] < lower - tolerance || position[i] > upper + tolerance) {
+          return false;
+        }
+      }
+      TetrahedronGeometry geometry = tetrahedron_geometry(mesh_, element);
+      const auto& p0 = mesh_.nodes[vertices[0]];
+      double sum = 0.0;
+      for(int i = 0; i < 3; ++i) {
+        double coordinate = 0.0;
+        for(int c = 0; c < 3; ++c) {
+          coordinate += geometry.inverse_jacobian[i][c] * (position[c] - p0[c]);
+        }
+        if(coordinate < -tolerance) {
+          return false;
+        }
+        sum += coordinate;
+      }
+      return sum <= 1.0 + tolerance;
+    }
+
+    TetrahedralMesh mesh_;
+    SparseMatrix<double> matrix_;
+    std::vector<double> preconditioner_;
+    KdTree node_tree_;
+    std::vector<std::size_t> electrode_vertices_;
+    bool mixed_precision_ = false;
+    SparseMatrix<float> float_matrix_;
+    std::vector<float> float_preconditioner_;
+    double inner_reduction_ = 0.0;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_P1_FORWARD_SOLVER_HH
@@ -0,0 +1,82 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_PARALLEL_FOR_HH
+#define DUNEURO_EEG_FORWARD_TEST_PARALLEL_FOR_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace duneuro_eeg_forward_test {
+
+  // number of threads to use if 0 is requested, i.e. all available cores
+  inline std::size_t resolve_number_of_threads(std::size_t number_of_threads)
+  {
+    if(number_of_threads == 0) {
+      number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return number_of_threads;
+  }
+
+  // call body(begin, end) for consecutive chunks of [0, size). The chunks are handed out dynamically
+  // to number_of_threads threads, so that workers finishing early take over the remaining chunks.
+  // body has to be safe to call concurrently for disjoint ranges. If a call throws, no further chunks
+  // are started and the first exception is rethrown in the calling thread.
+  template<class Body>
+  void parallel_for(std::size_t size, std::size_t number_of_threads, std::size_t chunk_size, Body&& body)
+  {
+    number_of_threads = std::min(resolve_number_of_threads(number_of_threads), size);
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+
+    if(number_of_threads <= 1) {
+      for(std::size_t begin = 0; begin < size; begin += chunk_size) {
+        body(begin, std::min(begin + chunk_size, size));
+      }
+      return;
+    }
+
+    std::atomic<std::size_t> next_chunk_begin{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr first_exception;
+    std::mutex exception_mutex;
+
+    auto worker = [&] () {
+      while(!failed) {
+        std::size_t begin = next_chunk_begin.fetch_add(chunk_size);
+        if(begin >= size) {
+          break;
+        }
+        try {
+          body(begin, std::min(begin + chunk_size, size));
+        }
+        catch(...) {
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if(!first_exception) {
+            first_exception = std::current_exception();
+          }
+          failed = true;
+        }
+      }
+    };
+
+    // the calling thread works as well
+    std::vector<std::thread> threads;
+    threads.reserve(number_of_threads - 1);
+    for(std::size_t i = 0; i < number_of_threads - 1; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for(auto& thread : threads) {
+      thread.join();
+    }
+
+    if(first_exception) {
+      std::rethrow_exception(first_exception);
+    }
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_PARALLEL_FOR_HH
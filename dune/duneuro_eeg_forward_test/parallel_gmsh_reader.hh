@@ -0,0 +1,268 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_PARALLEL_GMSH_READER_HH
+#define DUNEURO_EEG_FORWARD_TEST_PARALLEL_GMSH_READER_HH
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/mapped_file.hh>
+#include <dune/duneuro_eeg_forward_test/parallel_for.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  namespace gmsh_detail {
+
+    // cursor over a range of the mapped file. The parse functions skip leading blanks and do not allocate
+    struct Cursor {
+      const char* position;
+      const char* end;
+
+      void skip_blanks()
+      {
+        while(position < end && (*position == ' ' || *position == '\t' || *position == '\r')) {
+          ++position;
+        }
+      }
+
+      void skip_line()
+      {
+        const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        position = newline ? newline + 1 : end;
+      }
+
+      bool at_line_end()
+      {
+        skip_blanks();
+        return position >= end || *position == '\n';
+      }
+
+      std::size_t parse_unsigned()
+      {
+        skip_blanks();
+        if(position >= end || *position < '0' || *position > '9') {
+          DUNE_THROW(Dune::IOError, "expected an unsigned integer in gmsh file");
+        }
+        std::size_t value = 0;
+        while(position < end && *position >= '0' && *position <= '9') {
+          value = 10 * value + (*position - '0');
+          ++position;
+        }
+        return value;
+      }
+
+      // the sections parsed here are always followed by an $End marker, so strtod cannot run past the mapping
+      double parse_double()
+      {
+        skip_blanks();
+        char* number_end;
+        double value = std::strtod(position, &number_end);
+        if(number_end == position) {
+          DUNE_THROW(Dune::IOError, "expected a floating point number in gmsh file");
+        }
+        position = number_end;
+        return value;
+      }
+    };
+
+    // find the line starting with marker in [begin, end), returns a pointer to its first character
+    inline const char* find_line(const char* begin, const char* end, const char* marker)
+    {
+      std::size_t length = std::strlen(marker);
+      const char* position = begin;
+      while(position + length <= end) {
+        if(std::memcmp(position, marker, length) == 0 && (position == begin || position[-1] == '\n')) {
+          return position;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+        if(!newline) {
+          break;
+        }
+        position = newline + 1;
+      }
+      return nullptr;
+    }
+
+    // split [begin, end) into at most number_of_chunks ranges whose boundaries are line starts
+    inline std::vector<const char*> split_at_lines(const char* begin, const char* end, std::size_t number_of_chunks)
+    {
+      std::vector<const char*> boundaries{begin};
+      std::size_t chunk_length = (end - begin) / number_of_chunks + 1;
+      for(std::size_t i = 1; i < number_of_chunks; ++i) {
+        const char* split = std::max(boundaries.back(), std::min(begin + i * chunk_length, end));
+        const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+        split = newline ? newline + 1 : end;
+        if(split > boundaries.back() && split < end) {
+          boundaries.push_back(split);
+        }
+      }
+      boundaries.push_back(end);
+      return boundaries;
+    }
+
+    // the body of a section, i.e. the lines after the entry count, and the entry count itself
+    struct Section {
+      const char* begin;
+      const char* end;
+      std::size_t size;
+    };
+
+    inline Section find_section(const MappedFile& file, const char* name, const char* end_name, const std::string& filename)
+    {
+      const char* file_end = file.data() + file.size();
+      const char* header = find_line(file.data(), file_end, name);
+      const char* footer = header ? find_line(header, file_end, end_name) : nullptr;
+      if(!footer) {
+        DUNE_THROW(Dune::IOError, "section " << name << " not found in " << filename);
+      }
+      Cursor cursor{header, footer};
+      cursor.skip_line();
+      Section section;
+      section.size = cursor.parse_unsigned();
+      cursor.skip_line();
+      section.begin = cursor.position;
+      section.end = footer;
+      return section;
+    }
+
+  } // namespace gmsh_detail
+
+  // read an ASCII gmsh 2.2 file using several threads. The file is memory mapped, the node and element sections
+  // are split into chunks at line boundaries which are parsed concurrently. The result is identical to read_gmsh
+  inline TetrahedralMesh read_gmsh_parallel(const std::string& filename, std::size_t number_of_threads = 0)
+  {
+    using namespace gmsh_detail;
+    number_of_threads = resolve_number_of_threads(number_of_threads);
+    // more chunks than threads balance the load between chunks with different line lengths
+    std::size_t number_of_chunks = 4 * number_of_threads;
+
+    MappedFile file(filename);
+    TetrahedralMesh mesh;
+
+    // nodes, chunk local results are concatenated in file order afterwards
+    Section node_section = find_section(file, "$Nodes", "$EndNodes", filename);
+    std::vector<const char*> node_boundaries = split_at_lines(node_section.begin, node_section.end, number_of_chunks);
+    std::size_t number_of_node_chunks = node_boundaries.size() - 1;
+    std::vector<std::vector<std::size_t>> chunk_ids(number_of_node_chunks);
+    std::vector<std::vector<std::array<double, 3>>> chunk_nodes(number_of_node_chunks);
+
+    parallel_for(number_of_node_chunks, number_of_threads, 1, [&] (std::size_t chunk_begin, std::size_t chunk_end) {
+      for(std::size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+        Cursor cursor{node_boundaries[chunk], node_boundaries[chunk + 1]};
+        std::size_t expected_size = node_section.size * (cursor.end - cursor.position) / (node_section.end - node_section.begin + 1) + 1;
+        chunk_ids[chunk].reserve(expected_size);
+        chunk_nodes[chunk].reserve(expected_size);
+        while(cursor.position < cursor.end) {
+          if(cursor.at_line_end()) {
+            cursor.skip_line();
+            continue;
+          }
+          chunk_ids[chunk].push_back(cursor.parse_unsigned());
+          std::array<double, 3> node;
+          for(auto& coordinate : node) {
+            coordinate = cursor.parse_double();
+          }
+          chunk_nodes[chunk].push_back(node);
+          cursor.skip_line();
+        }
+      }
+    });
+
+    mesh.nodes.reserve(node_section.size);
+    std::size_t max_id = 0;
+    for(std::size_t chunk = 0; chunk < number_of_node_chunks; ++chunk) {
+      mesh.nodes.insert(mesh.nodes.end(), chunk_nodes[chunk].begin(), chunk_nodes[chunk].end());
+      for(std::size_t id : chunk_ids[chunk]) {
+        max_id = std::max(max_id, id);
+      }
+    }
+    if(mesh.nodes.size() != node_section.size) {
+      DUNE_THROW(Dune::IOError, "expected " << node_section.size << " nodes but found " << mesh.nodes.size() << " in " << filename);
+    }
+    constexpr unsigned int invalid_index = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> id_to_index(max_id + 1, invalid_index);
+    std::size_t index = 0;
+    for(std::size_t chunk = 0; chunk < number_of_node_chunks; ++chunk) {
+      for(std::size_t id : chunk_ids[chunk]) {
+        id_to_index[id] = index++;
+      }
+    }
+    chunk_ids.clear();
+    chunk_nodes.clear();
+
+    // elements, only tetrahedra are kept
+    Section element_section = find_section(file, "$Elements", "$EndElements", filename);
+    std::vector<const char*> element_boundaries = split_at_lines(element_section.begin, element_section.end, number_of_chunks);
+    std::size_t number_of_element_chunks = element_boundaries.size() - 1;
+    std::vector<std::vector<std::array<unsigned int, 4>>> chunk_elements(number_of_element_chunks);
+    std::vector<std::vector<std::size_t>> chunk_labels(number_of_element_chunks);
+    std::vector<std::size_t> chunk_entries(number_of_element_chunks, 0);
+
+    parallel_for(number_of_element_chunks, number_of_threads, 1, [&] (std::size_t chunk_begin, std::size_t chunk_end) {
+      for(std::size_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+        Cursor cursor{element_boundaries[chunk], element_boundaries[chunk + 1]};
+        std::size_t expected_size = element_section.size * (cursor.end - cursor.position) / (element_section.end - element_section.begin + 1) + 1;
+        chunk_elements[chunk].reserve(expected_size);
+        chunk_labels[chunk].reserve(expected_size);
+        while(cursor.position < cursor.end) {
+          if(cursor.at_line_end()) {
+            cursor.skip_line();
+            continue;
+          }
+          ++chunk_entries[chunk];
+          std::size_t id = cursor.parse_unsigned();
+          std::size_t type = cursor.parse_unsigned();
+          std::size_t number_of_tags = cursor.parse_unsigned();
+          std::size_t physical_tag = 0;
+          for(std::size_t t = 0; t < number_of_tags; ++t) {
+            std::size_t tag = cursor.parse_unsigned();
+            if(t == 0) {
+              physical_tag = tag;
+            }
+          }
+          if(type == gmsh_tetrahedron_type) {
+            std::array<unsigned int, 4> element;
+            for(auto& vertex : element) {
+              std::size_t node_id = cursor.parse_unsigned();
+              if(node_id >= id_to_index.size() || id_to_index[node_id] == invalid_index) {
+                DUNE_THROW(Dune::IOError, "element " << id << " references unknown node " << node_id << " in " << filename);
+              }
+              vertex = id_to_index[node_id];
+            }
+            chunk_elements[chunk].push_back(element);
+            chunk_labels[chunk].push_back(physical_tag);
+          }
+          cursor.skip_line();
+        }
+      }
+    });
+
+    std::size_t number_of_entries = 0;
+    std::size_t number_of_tetrahedra = 0;
+    for(std::size_t chunk = 0; chunk < number_of_element_chunks; ++chunk) {
+      number_of_entries += chunk_entries[chunk];
+      number_of_tetrahedra += chunk_elements[chunk].size();
+    }
+    if(number_of_entries != element_section.size) {
+      DUNE_THROW(Dune::IOError, "expected " << element_section.size << " elements but found " << number_of_entries << " in " << filename);
+    }
+    mesh.elements.reserve(number_of_tetrahedra);
+    mesh.labels.reserve(number_of_tetrahedra);
+    for(std::size_t chunk = 0; chunk < number_of_element_chunks; ++chunk) {
+      mesh.elements.insert(mesh.elements.end(), chunk_elements[chunk].begin(), chunk_elements[chunk].end());
+      mesh.labels.insert(mesh.labels.end(), chunk_labels[chunk].begin(), chunk_labels[chunk].end());
+    }
+
+    return mesh;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_PARALLEL_GMSH_READER_HH
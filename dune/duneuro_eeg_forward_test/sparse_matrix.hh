@@ -0,0 +1,150 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_SPARSE_MATRIX_HH
+#define DUNEURO_EEG_FORWARD_TEST_SPARSE_MATRIX_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // square matrix in compressed sparse row format. The columns of every row are sorted
+  template<class T>
+  struct SparseMatrix {
+    std::size_t size = 0;
+    std::vector<std::size_t> row_offsets;
+    std::vector<unsigned int> columns;
+    std::vector<T> values;
+
+    std::size_t number_of_nonzeros() const
+    {
+      return columns.size();
+    }
+
+    // y = A x
+    void multiply(const T* x, T* y) const
+    {
+      for(std::size_t row = 0; row < size; ++row) {
+        T sum = 0;
+        for(std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+          sum += values[k] * x[columns[k]];
+        }
+        y[row] = sum;
+      }
+    }
+
+    // Y = A X for block_size vectors stored interleaved, i.e. entry i of vector j is X[i * block_size + j].
+    // The matrix is traversed once for all vectors. Common block sizes are dispatched to kernels with a compile
+    // time block size, so that the loop over the vectors is unrolled and vectorized
+    void multiply_block(const T* x, T* y, std::size_t block_size) const
+    {
+      switch(block_size) {
+        case 1: multiply(x, y); break;
+        case 2: multiply_block_fixed<2>(x, y); break;
+        case 4: multiply_block_fixed<4>(x, y); break;
+        case 8: multiply_block_fixed<8>(x, y); break;
+        case 16: multiply_block_fixed<16>(x, y); break;
+        default:
+          for(std::size_t row = 0; row < size; ++row) {
+            T* y_row = y + row * block_size;
+            std::fill(y_row, y_row + block_size, T(0));
+            for(std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+              T value = values[k];
+              const T* x_row = x + static_cast<std::size_t>(columns[k]) * block_size;
+              for(std::size_t j = 0; j < block_size; ++j) {
+                y_row[j] += value * x_row[j];
+              }
+            }
+          }
+      }
+    }
+
+    template<std::size_t block_size>
+    void multiply_block_fixed(const T* x, T* y) const
+    {
+      for(std::size_t row = 0; row < size; ++row) {
+        T sum[block_size] = {};
+        for(std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+          T value = values[k];
+          const T* x_row = x + static_cast<std::size_t>(columns[k]) * block_size;
+          for(std::size_t j = 0; j < block_size; ++j) {
+            sum[j] += value * x_row[j];
+          }
+        }
+        std::copy(sum, sum + block_size, y + row * block_size);
+      }
+    }
+
+    std::vector<T> diagonal() const
+    {
+      std::vector<T> result(size, T(0));
+      for(std::size_t row = 0; row < size; ++row) {
+        for(std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+          if(columns[k] == row) {
+            result[row] = values[k];
+          }
+        }
+      }
+      return result;
+    }
+
+    // copy with values converted to U, e.g. a single precision copy for mixed precision solvers
+    template<class U>
+    SparseMatrix<U> convert() const
+    {
+      SparseMatrix<U> result;
+      result.size = size;
+      result.row_offsets = row_offsets;
+      result.columns = columns;
+      result.values.assign(values.begin(), values.end());
+      return result;
+    }
+
+    // entry (row, column), which has to be part of the sparsity pattern
+    T& entry(std::size_t row, std::size_t column)
+    {
+      auto begin = columns.begin() + row_offsets[row];
+      auto end = columns.begin() + row_offsets[row + 1];
+      auto position = std::lower_bound(begin, end, column);
+      if(position == end || *position != column) {
+        DUNE_THROW(Dune::RangeError, "entry (" << row << ", " << column << ") is not part of the sparsity pattern");
+      }
+      return values[position - columns.begin()];
+    }
+  };
+
+  // sparsity pattern of the matrix coupling all vertices of every element, values are set to zero
+  template<class T, class Elements>
+  SparseMatrix<T> make_element_pattern(std::size_t size, const Elements& elements)
+  {
+    std::vector<std::vector<unsigned int>> neighbors(size);
+    for(const auto& element : elements) {
+      for(auto i : element) {
+        for(auto j : element) {
+          neighbors[i].push_back(j);
+        }
+      }
+    }
+
+    SparseMatrix<T> matrix;
+    matrix.size = size;
+    matrix.row_offsets.resize(size + 1, 0);
+    for(std::size_t row = 0; row < size; ++row) {
+      auto& row_neighbors = neighbors[row];
+      std::sort(row_neighbors.begin(), row_neighbors.end());
+      row_neighbors.erase(std::unique(row_neighbors.begin(), row_neighbors.end()), row_neighbors.end());
+      matrix.row_offsets[row + 1] = matrix.row_offsets[row] + row_neighbors.size();
+    }
+    matrix.columns.reserve(matrix.row_offsets[size]);
+    for(auto& row_neighbors : neighbors) {
+      matrix.columns.insert(matrix.columns.end(), row_neighbors.begin(), row_neighbors.end());
+      std::vector<unsigned int>().swap(row_neighbors);
+    }
+    matrix.values.assign(matrix.columns.size(), T(0));
+    return matrix;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_SPARSE_MATRIX_HH
@@ -0,0 +1,172 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_SPHERE_MESH_GENERATOR_HH
+#define DUNEURO_EEG_FORWARD_TEST_SPHERE_MESH_GENERATOR_HH
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/mesh_refinement.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // labeled tetrahedral mesh of a multilayer sphere. Radii are ordered from the outermost to the innermost layer
+  // and an element in layer k gets label k, matching the order of the conductivities of the analytical solution.
+  // The bounding cube of the outer sphere is divided into cubes of edge length resolution, each split into 6
+  // tetrahedra along its main diagonal (Kuhn), and the tetrahedra whose centroid lies inside the outer sphere are kept.
+  // To reduce the staircase approximation of the interfaces, vertices closer than node_shift * resolution to a sphere
+  // are moved radially onto it. A shift that would invert an element is undone for the vertices of that element
+  inline TetrahedralMesh generate_sphere_mesh(const std::vector<double>& radii,
+                                              const std::array<double, 3>& center,
+                                              double resolution,
+                                              double node_shift = 0.3)
+  {
+    if(radii.empty() || resolution <= 0.0) {
+      DUNE_THROW(Dune::RangeError, "a sphere mesh needs at least one radius and a positive resolution");
+    }
+    for(std::size_t k = 1; k < radii.size(); ++k) {
+      if(radii[k] >= radii[k - 1]) {
+        DUNE_THROW(Dune::RangeError, "radii have to be strictly decreasing");
+      }
+    }
+    double outer_radius = radii[0];
+    // cells per direction, the grid is centered at the center of the sphere
+    std::size_t cells = static_cast<std::size_t>(std::ceil(2.0 * outer_radius / resolution));
+    double origin_offset = -0.5 * cells * resolution;
+    std::size_t points = cells + 1;
+    auto grid_index = [points] (std::size_t i, std::size_t j, std::size_t k) {
+      return (k * points + j) * points + i;
+    };
+    auto grid_position = [&] (std::size_t index) {
+      std::size_t i = index % points;
+      std::size_t j = (index / points) % points;
+      std::size_t k = index / (points * points);
+      return std::array<double, 3>{center[0] + origin_offset + i * resolution,
+                                   center[1] + origin_offset + j * resolution,
+                                   center[2] + origin_offset + k * resolution};
+    };
+    auto radius = [&center] (const std::array<double, 3>& position) {
+      double squared = 0.0;
+      for(int i = 0; i < 3; ++i) {
+        squared += (position[i] - center[i]) * (position[i] - center[i]);
+      }
+      return std::sqrt(squared);
+    };
+
+    // Kuhn subdivision, tetrahedron t of a cube visits the corners along the permutation t of the axes, which makes
+    // the tetrahedra of neighboring cubes conforming
+    constexpr std::array<std::array<int, 3>, 6> permutations = {{
+      {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}
+    }};
+
+    TetrahedralMesh mesh;
+    constexpr unsigned int unused = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> grid_to_node(points * points * points, unused);
+    for(std::size_t k = 0; k < cells; ++k) {
+      for(std::size_t j = 0; j < cells; ++j) {
+        for(std::size_t i = 0; i < cells; ++i) {
+          for(const auto& permutation : permutations) {
+            std::array<std::size_t, 3> corner = {i, j, k};
+            std::array<std::size_t, 4> tetrahedron;
+            tetrahedron[0] = grid_index(corner[0], corner[1], corner[2]);
+            for(int step = 0; step < 3; ++step) {
+              ++corner[permutation[step]];
+              tetrahedron[step + 1] = grid_index(corner[0], corner[1], corner[2]);
+            }
+
+            std::array<double, 3> centroid = {0.0, 0.0, 0.0};
+            for(std::size_t vertex : tetrahedron) {
+              auto position = grid_position(vertex);
+              for(int c = 0; c < 3; ++c) {
+                centroid[c] += 0.25 * position[c];
+              }
+            }
+            if(radius(centroid) >= outer_radius) {
+              continue;
+            }
+
+            std::array<unsigned int, 4> element;
+            for(int v = 0; v < 4; ++v) {
+              unsigned int& node = grid_to_node[tetrahedron[v]];
+              if(node == unused) {
+                node = mesh.nodes.size();
+                mesh.nodes.push_back(grid_position(tetrahedron[v]));
+              }
+              element[v] = node;
+            }
+            mesh.elements.push_back(element);
+          }
+        }
+      }
+    }
+
+    // consistent positive orientation before the vertices are moved
+    for(auto& element : mesh.elements) {
+      if(refinement_detail::orientation(mesh, element) < 0.0) {
+        std::swap(element[2], element[3]);
+      }
+    }
+
+    // node shift towards the closest sphere
+    std::vector<std::array<double, 3>> grid_nodes = mesh.nodes;
+    for(auto& node : mesh.nodes) {
+      double node_radius = radius(node);
+      if(node_radius == 0.0) {
+        continue;
+      }
+      double closest = radii[0];
+      for(double r : radii) {
+        if(std::abs(node_radius - r) < std::abs(node_radius - closest)) {
+          closest = r;
+        }
+      }
+      if(std::abs(node_radius - closest) < node_shift * resolution) {
+        for(int c = 0; c < 3; ++c) {
+          node[c] = center[c] + (node[c] - center[c]) * closest / node_radius;
+        }
+      }
+    }
+    // undo shifts producing flat or inverted elements until none are left
+    bool changed = true;
+    while(changed) {
+      changed = false;
+      for(const auto& element : mesh.elements) {
+        if(refinement_detail::orientation(mesh, element) <= 1e-3 * resolution * resolution * resolution) {
+          for(unsigned int vertex : element) {
+            if(mesh.nodes[vertex] != grid_nodes[vertex]) {
+              mesh.nodes[vertex] = grid_nodes[vertex];
+              changed = true;
+            }
+          }
+        }
+      }
+    }
+
+    // the layer of an element is determined by its centroid after the shift
+    mesh.labels.reserve(mesh.elements.size());
+    for(const auto& element : mesh.elements) {
+      std::array<double, 3> centroid = {0.0, 0.0, 0.0};
+      for(unsigned int vertex : element) {
+        for(int c = 0; c < 3; ++c) {
+          centroid[c] += 0.25 * mesh.nodes[vertex][c];
+        }
+      }
+      double centroid_radius = radius(centroid);
+      std::size_t label = 0;
+      while(label + 1 < radii.size() && centroid_radius < radii[label + 1]) {
+        ++label;
+      }
+      mesh.labels.push_back(label);
+    }
+
+    return mesh;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_SPHERE_MESH_GENERATOR_HH
@@ -0,0 +1,238 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_SPHERE_SERIES_SOLUTION_HH
+#define DUNEURO_EEG_FORWARD_TEST_SPHERE_SERIES_SOLUTION_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // potential of a current dipole at electrodes on the surface of a multilayer sphere with isotropic conductivities,
+  // computed from the series expansion of Zhang, "A fast method to compute surface potentials generated by dipoles
+  // within multilayer anisotropic spheres", 1995:
+  //
+  //   V = 1 / (4 pi sigma_N R^2) * sum_n (2n+1)/n (b/R)^(n-1) f_n [n (q.r0) P_n(x) + (q.(r - x r0)) P_n'(x)]
+  //
+  // where R and sigma_N are radius and conductivity of the outer layer, b the distance of the dipole to the center,
+  // r and r0 the unit vectors towards electrode and dipole, x = r.r0 and f_n a factor depending only on the layers.
+  // The electrodes are stored as structure of arrays and the Legendre recurrences are evaluated for blocks of
+  // block_size electrodes at once using the vector extensions of GCC and Clang. Electrodes are projected
+  // radially onto the outer sphere. The dipole has to lie inside the innermost layer. evaluate is thread safe.
+  template<std::size_t number_of_layers, std::size_t block_size = 4>
+  class SphereSeriesSolution {
+  public:
+    // radii and conductivities are ordered from the outermost to the innermost layer
+    SphereSeriesSolution(const std::array<double, number_of_layers>& radii,
+                         const std::array<double, 3>& center,
+                         const std::array<double, number_of_layers>& conductivities,
+                         const std::vector<std::array<double, 3>>& electrodes,
+                         double tolerance = 1e-16,
+                         std::size_t max_terms = 5000)
+      : outer_radius_(radii[0])
+      , innermost_radius_(radii[number_of_layers - 1])
+      , center_(center)
+      , tolerance_(tolerance)
+      , number_of_electrodes_(electrodes.size())
+    {
+      for(std::size_t i = 1; i < number_of_layers; ++i) {
+        if(radii[i] >= radii[i - 1]) {
+          DUNE_THROW(Dune::RangeError, "radii have to be strictly decreasing");
+        }
+      }
+      prefactor_ = 1.0 / (4.0 * M_PI * conductivities[0] * outer_radius_ * outer_radius_);
+
+      // structure of arrays of the electrode directions, padded to a multiple of the block size
+      std::size_t padded_size = ((number_of_electrodes_ + block_size - 1) / block_size) * block_size;
+      directions_[0].assign(padded_size, 0.0);
+      directions_[1].assign(padded_size, 0.0);
+      directions_[2].assign(padded_size, 1.0);
+      for(std::size_t e = 0; e < number_of_electrodes_; ++e) {
+        std::array<double, 3> direction;
+        double length = 0.0;
+        for(int i = 0; i < 3; ++i) {
+          direction[i] = electrodes[e][i] - center_[i];
+          length += direction[i] * direction[i];
+        }
+        length = std::sqrt(length);
+        for(int i = 0; i < 3; ++i) {
+          directions_[i][e] = direction[i] / length;
+        }
+      }
+
+      compute_layer_factors(radii, conductivities, max_terms);
+    }
+
+    std::vector<double> evaluate(const std::array<double, 3>& position, const std::array<double, 3>& moment) const
+    {
+      // dipole position relative to the center, for a dipole in the center only the first term is non-zero
+      // and any direction can be used for r0
+      std::array<double, 3> dipole_direction;
+      double b = 0.0;
+      for(int i = 0; i < 3; ++i) {
+        dipole_direction[i] = position[i] - center_[i];
+        b += dipole_direction[i] * dipole_direction[i];
+      }
+      b = std::sqrt(b);
+      if(b >= innermost_radius_) {
+        DUNE_THROW(Dune::RangeError, "dipole at distance " << b << " from the center is not inside the innermost layer");
+      }
+      if(b > 0.0) {
+        for(auto& entry : dipole_direction) {
+          entry /= b;
+        }
+      }
+      else {
+        dipole_direction = {0.0, 0.0, 1.0};
+      }
+      double q_radial = moment[0] * dipole_direction[0] + moment[1] * dipole_direction[1] + moment[2] * dipole_direction[2];
+
+      // series coefficients a_n = (2n+1)/n (b/R)^(n-1) f_n, truncated once the bound n^2 a_n of the n-th term
+      // relative to the first one drops below the tolerance
+      std::vector<double> coefficients;
+      coefficients.reserve(64);
+      double ratio = b / outer_radius_;
+      double power = 1.0;
+      for(std::size_t n = 1; n <= layer_factors_.size(); ++n) {
+        double coefficient = (2.0 * n + 1.0) / n * power * layer_factors_[n - 1];
+        coefficients.push_back(coefficient);
+        if(n > 1 && n * n * std::abs(coefficient) < tolerance_ * std::abs(coefficients[0])) {
+          break;
+        }
+        power *= ratio;
+      }
+      std::size_t number_of_terms = coefficients.size();
+
+      std::vector<double> potentials(directions_[0].size());
+      for(std::size_t block = 0; block < directions_[0].size(); block += block_size) {
+        evaluate_block(block, dipole_direction, moment, q_radial, coefficients.data(), number_of_terms, potentials.data() + block);
+      }
+      potentials.resize(number_of_electrodes_);
+      return potentials;
+    }
+
+    // number of precomputed layer factors, i.e. the maximal number of series terms
+    std::size_t max_terms() const
+    {
+      return layer_factors_.size();
+    }
+
+  private:
+    // f_n from the product of the 2x2 transfer matrices of all interfaces, computed as in the multilayer sphere model
+    // of MNE. The terms (r_k/R)^(2n+1) are inverted in the process, the number of terms is limited such that they
+    // stay above 1e-150 and the matrix products cannot overflow
+    void compute_layer_factors(const std::array<double, number_of_layers>& radii,
+                               const std::array<double, number_of_layers>& conductivities,
+                               std::size_t max_terms)
+    {
+      // layer k is counted from the innermost one, k = 0, to the outermost one, k = number_of_layers - 1
+      constexpr std::size_t L = number_of_layers;
+      std::array<double, L> relative_radius;
+      std::array<double, L> sigma;
+      for(std::size_t k = 0; k < L; ++k) {
+        relative_radius[k] = radii[L - 1 - k] / outer_radius_;
+        sigma[k] = conductivities[L - 1 - k];
+      }
+      double safe_terms = 0.5 * (std::log(1e-150) / std::log(relative_radius[0]) - 1.0);
+      max_terms = std::min<std::size_t>(max_terms, L > 1 ? static_cast<std::size_t>(safe_terms) : max_terms);
+
+      std::array<double, L> c1, c2, radius_power, radius_power_factor;
+      for(std::size_t k = 0; k + 1 < L; ++k) {
+        c1[k] = sigma[k] / sigma[k + 1];
+        c2[k] = c1[k] - 1.0;
+        radius_power[k] = relative_radius[k];
+        radius_power_factor[k] = relative_radius[k] * relative_radius[k];
+      }
+
+      layer_factors_.resize(max_terms);
+      for(std::size_t n = 1; n <= max_terms; ++n) {
+        double nd = n;
+        double n1 = nd + 1.0;
+        // m = A_0 A_1 ... A_{L-2}, with A_k the matrix of the interface between layer k and k+1
+        double m11 = 1.0, m12 = 0.0, m21 = 0.0, m22 = 1.0;
+        for(std::size_t kk = L - 1; kk-- > 0;) {
+          radius_power[kk] *= radius_power_factor[kk];
+          double a11 = nd + n1 * c1[kk];
+          double a12 = n1 * c2[kk] / radius_power[kk];
+          double a21 = nd * c2[kk] * radius_power[kk];
+          double a22 = n1 + nd * c1[kk];
+          double t11 = a11 * m11 + a12 * m21;
+          double t12 = a11 * m12 + a12 * m22;
+          double t21 = a21 * m11 + a22 * m21;
+          double t22 = a21 * m12 + a22 * m22;
+          m11 = t11; m12 = t12; m21 = t21; m22 = t22;
+        }
+        double numerator = nd * std::pow(2.0 * nd + 1.0, static_cast<double>(L - 1));
+        layer_factors_[n - 1] = prefactor_ * numerator / (nd * m22 + n1 * m21);
+      }
+    }
+
+    // one value per electrode of a block, mapped to SIMD registers by GCC and Clang
+    typedef double Lanes __attribute__((vector_size(block_size * sizeof(double))));
+
+    // passed by reference, returning vector types by value is subject to ABI differences between instruction sets
+    static void load(Lanes& lanes, const double* data)
+    {
+      std::memcpy(&lanes, data, sizeof(lanes));
+    }
+
+    // sum the series for the electrodes [block, block + block_size), each operation acts on all electrodes of the block
+    void evaluate_block(std::size_t block,
+                        const std::array<double, 3>& dipole_direction,
+                        const std::array<double, 3>& moment,
+                        double q_radial,
+                        const double* coefficients,
+                        std::size_t number_of_terms,
+                        double* out) const
+    {
+      Lanes rx, ry, rz;
+      load(rx, directions_[0].data() + block);
+      load(ry, directions_[1].data() + block);
+      load(rz, directions_[2].data() + block);
+
+      Lanes x = rx * dipole_direction[0] + ry * dipole_direction[1] + rz * dipole_direction[2];
+      Lanes q_tangential = rx * moment[0] + ry * moment[1] + rz * moment[2] - x * q_radial;
+
+      // P_0, P_1 and their derivatives
+      Lanes zero = x - x;
+      Lanes p_previous = zero + 1.0;
+      Lanes p = x;
+      Lanes dp_previous = zero;
+      Lanes dp = zero + 1.0;
+      Lanes sum = coefficients[0] * (q_radial * p + q_tangential * dp);
+
+      for(std::size_t n = 1; n < number_of_terms; ++n) {
+        double nd = n;
+        double alpha = (2.0 * nd + 1.0) / (nd + 1.0);
+        double beta = nd / (nd + 1.0);
+        // P_{n+1} = ((2n+1) x P_n - n P_{n-1}) / (n+1) and P'_{n+1} = P'_{n-1} + (2n+1) P_n
+        Lanes p_next = alpha * x * p - beta * p_previous;
+        Lanes dp_next = dp_previous + (2.0 * nd + 1.0) * p;
+        p_previous = p;
+        p = p_next;
+        dp_previous = dp;
+        dp = dp_next;
+        sum += (coefficients[n] * (nd + 1.0) * q_radial) * p + (coefficients[n] * q_tangential) * dp;
+      }
+
+      std::memcpy(out, &sum, sizeof(sum));
+    }
+
+    double outer_radius_;
+    double innermost_radius_;
+    std::array<double, 3> center_;
+    double tolerance_;
+    double prefactor_;
+    std::size_t number_of_electrodes_;
+    std::array<std::vector<double>, 3> directions_;
+    // f_n / (4 pi sigma_N R^2) for n = 1, 2, ...
+    std::vector<double> layer_factors_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_SPHERE_SERIES_SOLUTION_HH
@@ -0,0 +1,223 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_STAGE_PROFILER_HH
+#define DUNEURO_EEG_FORWARD_TEST_STAGE_PROFILER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/timer.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // peak resident set size of the process in kilobytes
+  inline long peak_rss_kb()
+  {
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) {
+      return -1;
+    }
+    return usage.ru_maxrss;
+  }
+
+  // accumulates wall clock time and number of calls per named stage. Stages are reported in the order they were
+  // first entered, for stages running on several threads the accumulated time is the sum over all threads.
+  // Every thread records into its own accumulators, so that stages inside threaded loops do not contend for a
+  // common lock. The peak resident set size is only recorded for stages entered with record_memory, since asking
+  // the kernel for it is too expensive for stages entered per dipole. It is -1 for the other stages
+  class StageProfiler {
+  public:
+    struct Stage {
+      std::string name;
+      std::size_t calls = 0;
+      double time = 0.0;
+      long peak_rss_kb = -1;
+    };
+
+    static constexpr bool record_memory = true;
+
+  private:
+    struct LocalStage {
+      Stage stage;
+      std::size_t order;
+    };
+
+    // accumulators of one thread. The mutex is only contended while the stages are collected for a report
+    struct ThreadStages {
+      std::mutex mutex;
+      std::deque<LocalStage> stages;
+    };
+
+  public:
+    // measures the time between its construction and destruction
+    class ScopedStage {
+    public:
+      ScopedStage(StageProfiler& profiler, const std::string& name, bool memory)
+        : thread_stages_(profiler.thread_stages())
+        , stage_(profiler.local_stage(thread_stages_, name))
+        , memory_(memory)
+        , timer_(true)
+      {
+      }
+
+      ScopedStage(const ScopedStage&) = delete;
+      ScopedStage& operator=(const ScopedStage&) = delete;
+
+      ~ScopedStage()
+      {
+        double time = timer_.elapsed();
+        long rss = memory_ ? peak_rss_kb() : -1;
+        std::lock_guard<std::mutex> lock(thread_stages_.mutex);
+        stage_.calls += 1;
+        stage_.time += time;
+        stage_.peak_rss_kb = std::max(stage_.peak_rss_kb, rss);
+      }
+
+    private:
+      ThreadStages& thread_stages_;
+      Stage& stage_;
+      bool memory_;
+      Dune::Timer timer_;
+    };
+
+    StageProfiler()
+      : id_(next_id()++)
+    {
+    }
+
+    StageProfiler(const StageProfiler&) = delete;
+    StageProfiler& operator=(const StageProfiler&) = delete;
+
+    ScopedStage scope(const std::string& name, bool memory = false)
+    {
+      return ScopedStage(*this, name, memory);
+    }
+
+    // the stages summed over all threads
+    std::vector<Stage> stages() const
+    {
+      std::vector<std::pair<std::size_t, Stage>> merged;
+      std::lock_guard<std::mutex> lock(mutex_);
+      for(const auto& thread : threads_) {
+        std::lock_guard<std::mutex> thread_lock(thread->mutex);
+        for(const auto& local : thread->stages) {
+          auto it = std::find_if(merged.begin(), merged.end(), [&local] (const auto& entry) {return entry.first == local.order;});
+          if(it == merged.end()) {
+            merged.emplace_back(local.order, Stage{local.stage.name});
+            it = merged.end() - 1;
+          }
+          it->second.calls += local.stage.calls;
+          it->second.time += local.stage.time;
+          it->second.peak_rss_kb = std::max(it->second.peak_rss_kb, local.stage.peak_rss_kb);
+        }
+      }
+      std::sort(merged.begin(), merged.end(), [] (const auto& a, const auto& b) {return a.first < b.first;});
+      std::vector<Stage> result;
+      for(auto& entry : merged) {
+        result.push_back(std::move(entry.second));
+      }
+      return result;
+    }
+
+    void report(std::ostream& out) const
+    {
+      out << " Stage timings\n";
+      out << std::setw(28) << "stage" << std::setw(10) << "calls" << std::setw(16) << "time [s]" << std::setw(18) << "peak rss [kB]" << "\n";
+      for(const auto& stage : stages()) {
+        out << std::setw(28) << stage.name
+            << std::setw(10) << stage.calls
+            << std::setw(16) << stage.time;
+        if(stage.peak_rss_kb >= 0) {
+          out << std::setw(18) << stage.peak_rss_kb << "\n";
+        }
+        else {
+          out << std::setw(18) << "-" << "\n";
+        }
+      }
+    }
+
+    // stages without a recorded peak memory have an empty peak_rss_kb
+    void write_csv(const std::string& filename) const
+    {
+      std::ofstream out(filename);
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "could not open " << filename);
+      }
+      out << std::setprecision(std::numeric_limits<double>::max_digits10);
+      out << "stage,calls,time,peak_rss_kb\n";
+      for(const auto& stage : stages()) {
+        out << stage.name << "," << stage.calls << "," << stage.time << ",";
+        if(stage.peak_rss_kb >= 0) {
+          out << stage.peak_rss_kb;
+        }
+        out << "\n";
+      }
+    }
+
+  private:
+    static std::atomic<std::size_t>& next_id()
+    {
+      static std::atomic<std::size_t> id{0};
+      return id;
+    }
+
+    // the accumulators of the calling thread, created on its first stage. Threads remember them per profiler id,
+    // which unlike the address is not reused by a later profiler
+    ThreadStages& thread_stages()
+    {
+      thread_local std::vector<std::pair<std::size_t, ThreadStages*>> known;
+      for(const auto& entry : known) {
+        if(entry.first == id_) {
+          return *entry.second;
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads_.push_back(std::make_unique<ThreadStages>());
+      known.emplace_back(id_, threads_.back().get());
+      return *threads_.back();
+    }
+
+    // the accumulator of name in thread, which gets the global order of name if it is new to the thread.
+    // The deque keeps the references to earlier stages valid
+    Stage& local_stage(ThreadStages& thread, const std::string& name)
+    {
+      for(auto& local : thread.stages) {
+        if(local.stage.name == name) {
+          return local.stage;
+        }
+      }
+      std::size_t order;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(names_.begin(), names_.end(), name);
+        order = it - names_.begin();
+        if(it == names_.end()) {
+          names_.push_back(name);
+        }
+      }
+      std::lock_guard<std::mutex> lock(thread.mutex);
+      thread.stages.push_back(LocalStage{Stage{name}, order});
+      return thread.stages.back().stage;
+    }
+
+    std::size_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadStages>> threads_;
+    std::vector<std::string> names_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_STAGE_PROFILER_HH
@@ -0,0 +1,113 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_SWEEP_REPORT_HH
+#define DUNEURO_EEG_FORWARD_TEST_SWEEP_REPORT_HH
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/dipole_errors.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // result of running the same dipoles with one variant of the configuration, e.g. one source model.
+  // values holds named measurements of the variant such as its runtime, all entries of a sweep are
+  // expected to have the same value names
+  struct SweepEntry {
+    std::string label;
+    std::vector<std::pair<std::string, double>> values;
+    std::vector<DipoleErrors> errors;
+  };
+
+  namespace sweep_detail {
+    struct ErrorColumn {
+      std::string name;
+      double DipoleErrors::* member;
+      bool use_max;
+    };
+
+    inline std::vector<ErrorColumn> error_columns()
+    {
+      return {
+        {"mean_re", &DipoleErrors::relative_error, false},
+        {"max_re", &DipoleErrors::relative_error, true},
+        {"mean_mag", &DipoleErrors::mag, false},
+        {"mean_rdm", &DipoleErrors::rdm, false},
+        {"max_rdm", &DipoleErrors::rdm, true}
+      };
+    }
+
+    inline double error_value(const SweepEntry& entry, const ErrorColumn& column)
+    {
+      ErrorStatistics statistics = compute_statistics(entry.errors, column.member);
+      return column.use_max ? statistics.max : statistics.mean;
+    }
+  } // namespace sweep_detail
+
+  // print one line per entry with its values and the statistics of its errors
+  inline void print_sweep_report(std::ostream& out, const std::string& label_name, const std::vector<SweepEntry>& entries)
+  {
+    constexpr int label_width = 26;
+    constexpr int width = 16;
+    out << std::setw(label_width) << label_name;
+    if(!entries.empty()) {
+      for(const auto& value : entries.front().values) {
+        out << std::setw(width) << value.first;
+      }
+    }
+    for(const auto& column : sweep_detail::error_columns()) {
+      out << std::setw(width) << column.name;
+    }
+    out << "\n";
+
+    for(const auto& entry : entries) {
+      out << std::setw(label_width) << entry.label;
+      for(const auto& value : entry.values) {
+        out << std::setw(width) << value.second;
+      }
+      for(const auto& column : sweep_detail::error_columns()) {
+        out << std::setw(width) << sweep_detail::error_value(entry, column);
+      }
+      out << "\n";
+    }
+  }
+
+  // same table as print_sweep_report in csv format
+  inline void write_sweep_csv(const std::string& filename, const std::string& label_name, const std::vector<SweepEntry>& entries)
+  {
+    std::ofstream out(filename);
+    if(!out) {
+      DUNE_THROW(Dune::IOError, "could not open " << filename);
+    }
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << label_name;
+    if(!entries.empty()) {
+      for(const auto& value : entries.front().values) {
+        out << "," << value.first;
+      }
+    }
+    for(const auto& column : sweep_detail::error_columns()) {
+      out << "," << column.name;
+    }
+    out << "\n";
+
+    for(const auto& entry : entries) {
+      out << entry.label;
+      for(const auto& value : entry.values) {
+        out << "," << value.second;
+      }
+      for(const auto& column : sweep_detail::error_columns()) {
+        out << "," << sweep_detail::error_value(entry, column);
+      }
+      out << "\n";
+    }
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_SWEEP_REPORT_HH
@@ -0,0 +1,130 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/analytic_solution_cache.hh>
+
+using duneuro_eeg_forward_test::AnalyticSolutionCache;
+
+// every input of the analytical solution has to change the key of the cached potentials
+Dune::TestSuite test_keys()
+{
+  Dune::TestSuite suite("keys");
+  std::array<double, 4> radii = {92.0, 86.0, 80.0, 78.0};
+  std::array<double, 3> center = {127.0, 127.0, 127.0};
+  std::array<double, 4> conductivities = {0.43, 0.0016, 1.79, 0.33};
+  std::vector<std::array<double, 3>> electrodes = {{127.0, 127.0, 219.0}, {219.0, 127.0, 127.0}};
+  auto key = [&] () {
+    return duneuro_eeg_forward_test::analytic_setup_hash("series", radii, center, conductivities, electrodes);
+  };
+  std::uint64_t reference = key();
+  suite.check(key() == reference) << "the key is not deterministic";
+  suite.check(duneuro_eeg_forward_test::analytic_setup_hash("simbiosphere", radii, center, conductivities, electrodes) != reference) << "the method does not change the key";
+  radii[2] = 80.5;
+  suite.check(key() != reference) << "the radii do not change the key";
+  radii[2] = 80.0;
+  center[1] = 128.0;
+  suite.check(key() != reference) << "the center does not change the key";
+  center[1] = 127.0;
+  conductivities[1] = 0.01;
+  suite.check(key() != reference) << "the conductivities do not change the key";
+  conductivities[1] = 0.0016;
+  electrodes[1][2] = 127.5;
+  suite.check(key() != reference) << "the electrode positions do not change the key";
+  electrodes[1][2] = 127.0;
+  electrodes.pop_back();
+  suite.check(key() != reference) << "the number of electrodes does not change the key";
+
+  std::array<double, 3> position = {127.0, 127.0, 150.0};
+  std::array<double, 3> moment = {0.0, 0.0, 1.0};
+  std::array<double, 3> other_moment = {0.0, 1.0, 0.0};
+  suite.check(duneuro_eeg_forward_test::analytic_dipole_hash(position, moment) != duneuro_eeg_forward_test::analytic_dipole_hash(position, other_moment))
+    << "the moment does not change the dipole key";
+  suite.check(duneuro_eeg_forward_test::analytic_dipole_hash(position, moment) != duneuro_eeg_forward_test::analytic_dipole_hash(moment, position))
+    << "position and moment are interchangeable in the dipole key";
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  suite.subTest(test_keys());
+  const std::string filename = "analyticsolutioncachetest.cache";
+  std::remove(filename.c_str());
+  std::vector<double> potentials;
+
+  {
+    AnalyticSolutionCache cache(filename, 1, 3);
+    suite.check(!cache.find(7, potentials)) << "entry found in a new cache";
+    cache.insert(7, {1.0, 2.0, 3.0});
+    suite.check(cache.find(7, potentials) && potentials == std::vector<double>{1.0, 2.0, 3.0}) << "inserted entry not found";
+    cache.save();
+  }
+
+  // the entries are reused for the same setup and ignored for a different setup or number of electrodes
+  {
+    AnalyticSolutionCache cache(filename, 1, 3);
+    suite.check(cache.find(7, potentials) && potentials == std::vector<double>{1.0, 2.0, 3.0}) << "saved entry not found";
+    suite.check(cache.hits() == 1 && cache.misses() == 0) << "hits and misses are not counted";
+  }
+  {
+    AnalyticSolutionCache cache(filename, 2, 3);
+    suite.check(!cache.find(7, potentials)) << "entry of a different setup found";
+  }
+  {
+    AnalyticSolutionCache cache(filename, 1, 4);
+    suite.check(!cache.find(7, potentials)) << "entry with a different number of electrodes found";
+  }
+
+  // saving a different setup replaces the file, the entries of the old setup are gone
+  {
+    AnalyticSolutionCache cache(filename, 2, 3);
+    cache.insert(8, {4.0, 5.0, 6.0});
+    cache.save();
+  }
+  {
+    AnalyticSolutionCache cache(filename, 1, 3);
+    suite.check(!cache.find(7, potentials)) << "entry of a replaced setup found";
+  }
+
+  // processes saving at the same time, e.g. the MPI ranks, keep the entries of each other
+  std::remove(filename.c_str());
+  constexpr int number_of_processes = 8;
+  constexpr int entries_per_process = 200;
+  for(int process = 0; process < number_of_processes; ++process) {
+    if(::fork() == 0) {
+      AnalyticSolutionCache cache(filename, 1, 3);
+      for(int i = 0; i < entries_per_process; ++i) {
+        cache.insert(process * entries_per_process + i, {1.0 * process, 1.0 * i, 0.0});
+      }
+      cache.save();
+      ::_exit(0);
+    }
+  }
+  int status;
+  while(::wait(&status) > 0) {
+  }
+  {
+    AnalyticSolutionCache cache(filename, 1, 3);
+    int found = 0;
+    for(int key = 0; key < number_of_processes * entries_per_process; ++key) {
+      found += cache.find(key, potentials) && potentials[0] == key / entries_per_process && potentials[1] == key % entries_per_process;
+    }
+    suite.check(found == number_of_processes * entries_per_process) << "only " << found << " entries of concurrent saves were kept";
+  }
+
+  std::remove(filename.c_str());
+  std::remove((filename + ".lock").c_str());
+  return suite.exit();
+}
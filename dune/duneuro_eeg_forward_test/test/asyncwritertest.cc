@@ -0,0 +1,93 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/async_writer.hh>
+
+namespace {
+  // data owned by a task, its destruction is slow and recorded
+  struct Snapshot {
+    explicit Snapshot(std::atomic<std::size_t>& counter)
+      : destroyed(counter)
+    {
+    }
+
+    Snapshot(const Snapshot&) = delete;
+
+    ~Snapshot()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      ++destroyed;
+    }
+
+    std::atomic<std::size_t>& destroyed;
+  };
+}
+
+// the tasks run in the order they were submitted. Once wait returns, the data owned by the tasks is destroyed, so
+// that the caller may destroy the objects it refers to
+Dune::TestSuite test_order_and_lifetime(bool asynchronous)
+{
+  Dune::TestSuite suite(asynchronous ? "asynchronous" : "synchronous");
+  duneuro_eeg_forward_test::AsyncWriter writer(asynchronous, 2);
+  std::vector<std::size_t> order;
+  std::atomic<std::size_t> destroyed{0};
+  const std::size_t number_of_tasks = 20;
+  for(std::size_t i = 0; i < number_of_tasks; ++i) {
+    auto snapshot = std::make_shared<Snapshot>(destroyed);
+    writer.submit([&order, snapshot, i] () {
+      order.push_back(i);
+    });
+  }
+  writer.wait();
+  suite.check(destroyed == number_of_tasks) << destroyed << " of " << number_of_tasks << " snapshots destroyed after wait";
+  suite.require(order.size() == number_of_tasks) << order.size() << " tasks ran";
+  for(std::size_t i = 0; i < number_of_tasks; ++i) {
+    suite.check(order[i] == i) << "task " << order[i] << " ran at position " << i;
+  }
+  return suite;
+}
+
+// the exception of a failed task is rethrown once, the tasks queued behind it are dropped
+Dune::TestSuite test_exception()
+{
+  Dune::TestSuite suite("exception");
+  duneuro_eeg_forward_test::AsyncWriter writer(true, 4);
+  std::atomic<std::size_t> destroyed{0};
+  writer.submit([] () { throw std::runtime_error("write failed"); });
+  auto snapshot = std::make_shared<Snapshot>(destroyed);
+  bool thrown = false;
+  try {
+    writer.submit([snapshot] () {});
+    writer.wait();
+  }
+  catch(std::runtime_error&) {
+    thrown = true;
+  }
+  suite.check(thrown) << "the exception of the task was not rethrown";
+  writer.wait();
+  bool ran = false;
+  writer.submit([&ran] () { ran = true; });
+  writer.wait();
+  suite.check(ran) << "the writer did not recover after rethrowing";
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  suite.subTest(test_order_and_lifetime(true));
+  suite.subTest(test_order_and_lifetime(false));
+  suite.subTest(test_exception());
+  return suite.exit();
+}
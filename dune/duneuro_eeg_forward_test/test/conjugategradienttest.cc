@@ -0,0 +1,175 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/conjugate_gradient.hh>
+#include <dune/duneuro_eeg_forward_test/iterative_refinement.hh>
+#include <dune/duneuro_eeg_forward_test/sparse_matrix.hh>
+
+namespace {
+  // symmetric positive definite matrix of a diffusion problem with random edge weights on an n x n grid with
+  // Dirichlet boundary, i.e. every grid point couples to its four neighbors
+  duneuro_eeg_forward_test::SparseMatrix<double> make_grid_matrix(std::size_t n)
+  {
+    std::vector<std::vector<unsigned int>> elements;
+    for(std::size_t i = 0; i < n; ++i) {
+      for(std::size_t j = 0; j < n; ++j) {
+        if(i + 1 < n) {
+          elements.push_back({static_cast<unsigned int>(i * n + j), static_cast<unsigned int>((i + 1) * n + j)});
+        }
+        if(j + 1 < n) {
+          elements.push_back({static_cast<unsigned int>(i * n + j), static_cast<unsigned int>(i * n + j + 1)});
+        }
+      }
+    }
+    auto matrix = duneuro_eeg_forward_test::make_element_pattern<double>(n * n, elements);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> weight(0.1, 10.0);
+    for(const auto& edge : elements) {
+      double w = weight(generator);
+      matrix.entry(edge[0], edge[0]) += w;
+      matrix.entry(edge[1], edge[1]) += w;
+      matrix.entry(edge[0], edge[1]) -= w;
+      matrix.entry(edge[1], edge[0]) -= w;
+    }
+    // the Dirichlet boundary makes the matrix regular
+    for(std::size_t row = 0; row < n * n; ++row) {
+      matrix.entry(row, row) += 1.0;
+    }
+    return matrix;
+  }
+
+  std::vector<double> random_vector(std::size_t size, unsigned int seed)
+  {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    std::vector<double> result(size);
+    for(auto& entry : result) {
+      entry = value(generator);
+    }
+    return result;
+  }
+
+  double residual_reduction(const duneuro_eeg_forward_test::SparseMatrix<double>& matrix, const std::vector<double>& b, const std::vector<double>& x)
+  {
+    std::vector<double> r(b.size());
+    matrix.multiply(x.data(), r.data());
+    for(std::size_t i = 0; i < r.size(); ++i) {
+      r[i] = b[i] - r[i];
+    }
+    return std::sqrt(duneuro_eeg_forward_test::dot(r, r) / duneuro_eeg_forward_test::dot(b, b));
+  }
+}
+
+// every vector of a block follows the recurrence of single vector CG, hence it has to reach the same solution in
+// the same number of iterations. Block sizes with and without a specialized kernel are tested
+Dune::TestSuite test_block_matches_single(const duneuro_eeg_forward_test::SparseMatrix<double>& matrix, std::size_t block_size)
+{
+  Dune::TestSuite suite("block_cg_" + std::to_string(block_size));
+  const double reduction = 1e-10;
+  const std::size_t size = matrix.size;
+  auto preconditioner = duneuro_eeg_forward_test::inverse_diagonal(matrix);
+
+  std::vector<double> block_b(size * block_size), block_x(size * block_size, 0.0);
+  std::vector<std::vector<double>> single_x(block_size);
+  std::size_t max_single_iterations = 0;
+  for(std::size_t j = 0; j < block_size; ++j) {
+    std::vector<double> b = random_vector(size, j + 1);
+    // the last vector is zero, which has to be solved without breaking the others
+    if(j + 1 == block_size && block_size > 2) {
+      b.assign(size, 0.0);
+    }
+    for(std::size_t i = 0; i < size; ++i) {
+      block_b[i * block_size + j] = b[i];
+    }
+    single_x[j].assign(size, 0.0);
+    auto result = duneuro_eeg_forward_test::conjugate_gradient(matrix, preconditioner, b, single_x[j], reduction, 10000);
+    suite.require(result.converged) << "single vector CG did not converge for vector " << j;
+    max_single_iterations = std::max(max_single_iterations, result.iterations);
+  }
+
+  auto result = duneuro_eeg_forward_test::block_conjugate_gradient(matrix, preconditioner, block_b, block_x, block_size, reduction, 10000);
+  suite.check(result.converged) << "block CG did not converge";
+  suite.check(result.reduction <= reduction) << "block CG reports reduction " << result.reduction;
+  suite.check(result.iterations + 1 >= max_single_iterations && result.iterations <= max_single_iterations + 1)
+    << "block CG took " << result.iterations << " iterations, single vector CG up to " << max_single_iterations;
+
+  for(std::size_t j = 0; j < block_size; ++j) {
+    std::vector<double> x(size), b(size);
+    double difference = 0.0;
+    double norm = 0.0;
+    for(std::size_t i = 0; i < size; ++i) {
+      x[i] = block_x[i * block_size + j];
+      b[i] = block_b[i * block_size + j];
+      difference = std::max(difference, std::abs(x[i] - single_x[j][i]));
+      norm = std::max(norm, std::abs(single_x[j][i]));
+    }
+    suite.check(difference <= 1e-8 * std::max(norm, 1.0))
+      << "vector " << j << " differs by " << difference << " from the single vector solution";
+    if(duneuro_eeg_forward_test::dot(b, b) > 0.0) {
+      suite.check(residual_reduction(matrix, b, x) <= reduction) << "vector " << j << " did not reach the reduction";
+    }
+  }
+  return suite;
+}
+
+// the inner CG only reaches about single precision, the refinement has to reach a reduction far below it. The
+// result must agree with double precision CG, and the inner iterations are reported summed over the refinements
+Dune::TestSuite test_mixed_precision_refinement(const duneuro_eeg_forward_test::SparseMatrix<double>& matrix, double reduction)
+{
+  Dune::TestSuite suite("mixed_precision_refinement");
+  const std::size_t size = matrix.size;
+  auto float_matrix = matrix.convert<float>();
+  auto float_preconditioner = duneuro_eeg_forward_test::inverse_diagonal(float_matrix);
+  std::vector<double> b = random_vector(size, 7);
+
+  std::vector<double> x(size, 0.0);
+  auto result = duneuro_eeg_forward_test::mixed_precision_refinement(matrix, float_matrix, float_preconditioner, b, x, reduction, 1e-4, 10000);
+  suite.check(result.converged) << "refinement did not reach reduction " << reduction << ", got " << result.reduction;
+  suite.check(result.refinements > 1) << "a reduction of " << reduction << " was reached by a single float solve";
+  suite.check(result.iterations > 0);
+  double actual_reduction = residual_reduction(matrix, b, x);
+  suite.check(actual_reduction <= reduction) << "residual reduction is " << actual_reduction << " instead of " << reduction;
+  suite.check(std::abs(actual_reduction - result.reduction) <= 1e-3 * reduction) << "the reported reduction differs from the residual";
+
+  std::vector<double> reference(size, 0.0);
+  duneuro_eeg_forward_test::conjugate_gradient(matrix, duneuro_eeg_forward_test::inverse_diagonal(matrix), b, reference, reduction, 10000);
+  double difference = 0.0;
+  double norm = 0.0;
+  for(std::size_t i = 0; i < size; ++i) {
+    difference = std::max(difference, std::abs(x[i] - reference[i]));
+    norm = std::max(norm, std::abs(reference[i]));
+  }
+  suite.check(difference <= 1e3 * reduction * norm) << "refined solution differs by " << difference << " from double precision CG";
+
+  // a zero right hand side yields the zero solution, an unreachable reduction stops after max_refinements
+  std::vector<double> zero_b(size, 0.0), zero_x(size, 1.0);
+  suite.check(duneuro_eeg_forward_test::mixed_precision_refinement(matrix, float_matrix, float_preconditioner, zero_b, zero_x, reduction, 1e-4, 10000).converged);
+  suite.check(zero_x == std::vector<double>(size, 0.0)) << "zero right hand side did not yield zero";
+  std::vector<double> y(size, 0.0);
+  auto limited = duneuro_eeg_forward_test::mixed_precision_refinement(matrix, float_matrix, float_preconditioner, b, y, 1e-30, 1e-4, 10000, 3);
+  suite.check(!limited.converged && limited.refinements == 3) << "refinement did not stop after 3 steps";
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  auto matrix = make_grid_matrix(24);
+  for(std::size_t block_size : {1, 2, 3, 4, 8, 16}) {
+    suite.subTest(test_block_matches_single(matrix, block_size));
+  }
+  for(double reduction : {1e-8, 1e-12, 1e-14}) {
+    suite.subTest(test_mixed_precision_refinement(matrix, reduction));
+  }
+  return suite.exit();
+}
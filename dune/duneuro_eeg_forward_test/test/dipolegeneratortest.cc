@@ -0,0 +1,110 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/dipole_generator.hh>
+
+namespace {
+  const std::array<double, 3> center = {127.0, 127.0, 127.0};
+  const double inner_radius = 78.0;
+
+  double dot(const std::array<double, 3>& a, const std::array<double, 3>& b)
+  {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
+
+  template<class F>
+  bool throws(F&& f)
+  {
+    try {
+      f();
+    }
+    catch(Dune::Exception&) {
+      return true;
+    }
+    return false;
+  }
+}
+
+// the dipoles are ordered by eccentricity, direction and orientation. Every dipole lies at its eccentricity, the
+// eccentricities are spaced evenly from the minimum to the maximum, and the moments are unit vectors which are
+// parallel to the radial direction for radial and orthogonal to it for tangential dipoles
+Dune::TestSuite test_grid(std::size_t directions, double eccentricity_min, double eccentricity_max, std::size_t steps, const std::string& orientation)
+{
+  Dune::TestSuite suite("dipole_grid_" + orientation + "_" + std::to_string(steps));
+  auto dipoles = duneuro_eeg_forward_test::generate_dipole_grid(center, inner_radius, directions, eccentricity_min, eccentricity_max, steps, orientation);
+  std::size_t per_position = orientation == "both" ? 2 : 1;
+  suite.require(dipoles.size() == steps * directions * per_position) << "generated " << dipoles.size() << " dipoles";
+
+  for(std::size_t index = 0; index < dipoles.size(); ++index) {
+    const auto& dipole = dipoles[index];
+    std::size_t step = index / (directions * per_position);
+    double expected_eccentricity = steps > 1 ? eccentricity_min + (eccentricity_max - eccentricity_min) * step / (steps - 1) : eccentricity_min;
+
+    std::array<double, 3> offset;
+    for(int i = 0; i < 3; ++i) {
+      offset[i] = dipole.position[i] - center[i];
+    }
+    double eccentricity = std::sqrt(dot(offset, offset)) / inner_radius;
+    suite.check(std::abs(eccentricity - expected_eccentricity) <= 1e-12) << "dipole " << index << " has eccentricity " << eccentricity
+                                                                         << " instead of " << expected_eccentricity;
+    suite.check(eccentricity >= eccentricity_min - 1e-12 && eccentricity <= eccentricity_max + 1e-12)
+      << "dipole " << index << " lies outside of the eccentricity bounds";
+
+    suite.check(std::abs(dot(dipole.moment, dipole.moment) - 1.0) <= 1e-12) << "moment of dipole " << index << " is not a unit vector";
+    bool radial = orientation == "radial" || (orientation == "both" && index % 2 == 0);
+    // a dipole at the center has no radial direction
+    if(eccentricity == 0.0) {
+      continue;
+    }
+    double radial_part = dot(dipole.moment, offset) / std::sqrt(dot(offset, offset));
+    if(radial) {
+      suite.check(std::abs(radial_part - 1.0) <= 1e-12) << "dipole " << index << " is not radial";
+    }
+    else {
+      suite.check(std::abs(radial_part) <= 1e-12) << "dipole " << index << " is not tangential";
+    }
+
+    // the same directions are used for every eccentricity
+    if(step > 0) {
+      const auto& inner = dipoles[index - directions * per_position];
+      std::array<double, 3> inner_offset;
+      for(int i = 0; i < 3; ++i) {
+        inner_offset[i] = inner.position[i] - center[i];
+      }
+      suite.check(std::abs(dot(offset, inner_offset) - std::sqrt(dot(offset, offset) * dot(inner_offset, inner_offset))) <= 1e-9)
+        << "dipole " << index << " does not share its direction with the previous eccentricity";
+    }
+  }
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  // 50 directions include directions close to the poles, whose tangential moments are derived from the x axis
+  for(const std::string orientation : {"radial", "tangential", "both"}) {
+    suite.subTest(test_grid(50, 0.1, 0.98, 5, orientation));
+  }
+  suite.subTest(test_grid(7, 0.5, 0.5, 1, "both"));
+  suite.subTest(test_grid(3, 0.0, 0.9, 2, "tangential"));
+
+  suite.check(throws([] {duneuro_eeg_forward_test::generate_dipole_grid(center, inner_radius, 10, 0.1, 1.0, 3, "radial");}))
+    << "an eccentricity of 1 was accepted";
+  suite.check(throws([] {duneuro_eeg_forward_test::generate_dipole_grid(center, inner_radius, 10, 0.5, 0.4, 3, "radial");}))
+    << "a minimum above the maximum was accepted";
+  suite.check(throws([] {duneuro_eeg_forward_test::generate_dipole_grid(center, inner_radius, 10, 0.1, 0.9, 0, "radial");}))
+    << "zero eccentricity steps were accepted";
+  suite.check(throws([] {duneuro_eeg_forward_test::generate_dipole_grid(center, inner_radius, 10, 0.1, 0.9, 3, "diagonal");}))
+    << "an unknown orientation was accepted";
+  return suite.exit();
+}
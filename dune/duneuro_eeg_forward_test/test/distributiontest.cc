@@ -0,0 +1,69 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/dipole_errors.hh>
+#include <dune/duneuro_eeg_forward_test/distribution.hh>
+
+// the blocks of all ranks cover [0, size) in rank order and differ in size by at most one
+Dune::TestSuite test_block_range(int number_of_ranks)
+{
+  Dune::TestSuite suite("block_range");
+  for(std::size_t size = 0; size < 4 * static_cast<std::size_t>(number_of_ranks) + 3; ++size) {
+    std::size_t expected_first = 0;
+    for(int rank = 0; rank < number_of_ranks; ++rank) {
+      auto range = duneuro_eeg_forward_test::block_range(size, rank, number_of_ranks);
+      std::size_t block_size = range.second - range.first;
+      suite.check(range.first == expected_first) << "block of rank " << rank << " for size " << size << " is not contiguous";
+      suite.check(block_size == size / number_of_ranks || block_size == size / number_of_ranks + 1)
+        << "block of rank " << rank << " for size " << size << " has " << block_size << " entries";
+      expected_first = range.second;
+    }
+    suite.check(expected_first == size) << "blocks for size " << size << " end at " << expected_first;
+  }
+  return suite;
+}
+
+// every rank fills its block with values identifying the dipole, the root has to receive all of them at their index
+template<class Communication>
+Dune::TestSuite test_gather(const Communication& communication, std::size_t number_of_dipoles)
+{
+  Dune::TestSuite suite("gather_dipole_errors");
+  std::vector<duneuro_eeg_forward_test::DipoleErrors> errors(number_of_dipoles);
+  auto range = duneuro_eeg_forward_test::block_range(number_of_dipoles, communication.rank(), communication.size());
+  for(std::size_t i = range.first; i < range.second; ++i) {
+    errors[i] = {1.0 * i, 2.0 * i, 3.0 * i, 4.0 * i, 5.0 * i + 1.0};
+  }
+  duneuro_eeg_forward_test::gather_dipole_errors(communication, errors);
+
+  if(communication.rank() == 0) {
+    for(std::size_t i = 0; i < number_of_dipoles; ++i) {
+      const auto& e = errors[i];
+      suite.check(e.norm_analytical == 1.0 * i && e.norm_numerical == 2.0 * i && e.relative_error == 3.0 * i
+                  && e.mag == 4.0 * i && e.rdm == 5.0 * i + 1.0)
+        << "dipole " << i << " of " << number_of_dipoles << " was not gathered at its index";
+    }
+  }
+  return suite;
+}
+
+int main(int argc, char** argv)
+{
+  Dune::MPIHelper& helper = Dune::MPIHelper::instance(argc, argv);
+  auto communication = helper.getCommunication();
+
+  Dune::TestSuite suite;
+  suite.subTest(test_block_range(helper.size()));
+  suite.subTest(test_block_range(7));
+  // fewer dipoles than ranks leaves some ranks without dipoles
+  for(std::size_t number_of_dipoles : {0, 1, 2, 5, 37}) {
+    suite.subTest(test_gather(communication, number_of_dipoles));
+  }
+  return suite.exit();
+}
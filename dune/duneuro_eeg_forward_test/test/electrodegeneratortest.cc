@@ -0,0 +1,65 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/electrode_generator.hh>
+
+namespace {
+  double distance(const std::array<double, 3>& a, const std::array<double, 3>& b)
+  {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+  }
+}
+
+// the electrodes lie on the sphere and are spread quasi uniformly: the distance of every electrode to its nearest
+// neighbor is close to the edge length of a cell of area 4 pi r^2 / N, and the electrodes are centered around the center
+Dune::TestSuite test_fibonacci(std::size_t number_of_electrodes)
+{
+  Dune::TestSuite suite("fibonacci_" + std::to_string(number_of_electrodes));
+  const std::array<double, 3> center = {127.0, 120.0, 131.0};
+  const double radius = 92.0;
+  auto electrodes = duneuro_eeg_forward_test::generate_fibonacci_electrodes(number_of_electrodes, center, radius);
+  suite.require(electrodes.size() == number_of_electrodes) << "generated " << electrodes.size() << " electrodes";
+
+  const double cell_size = radius * std::sqrt(4.0 * M_PI / number_of_electrodes);
+  std::array<double, 3> centroid = {0.0, 0.0, 0.0};
+  std::size_t upper_hemisphere = 0;
+  for(std::size_t i = 0; i < number_of_electrodes; ++i) {
+    suite.check(std::abs(distance(electrodes[i], center) - radius) <= 1e-10 * radius) << "electrode " << i << " is not on the sphere";
+    double nearest = std::numeric_limits<double>::max();
+    for(std::size_t j = 0; j < number_of_electrodes; ++j) {
+      if(j != i) {
+        nearest = std::min(nearest, distance(electrodes[i], electrodes[j]));
+      }
+    }
+    suite.check(nearest >= 0.8 * cell_size && nearest <= 1.1 * cell_size)
+      << "nearest neighbor of electrode " << i << " is at " << nearest << ", the cell size is " << cell_size;
+    for(int k = 0; k < 3; ++k) {
+      centroid[k] += (electrodes[i][k] - center[k]) / number_of_electrodes;
+    }
+    upper_hemisphere += electrodes[i][2] > center[2];
+  }
+  suite.check(distance(centroid, {0.0, 0.0, 0.0}) <= 0.05 * radius) << "electrodes are not centered around the center";
+  suite.check(upper_hemisphere == number_of_electrodes / 2) << upper_hemisphere << " electrodes on the upper hemisphere";
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  suite.check(duneuro_eeg_forward_test::generate_fibonacci_electrodes(0, {0.0, 0.0, 0.0}, 1.0).empty());
+  for(std::size_t number_of_electrodes : {10, 64, 256, 1000}) {
+    suite.subTest(test_fibonacci(number_of_electrodes));
+  }
+  return suite.exit();
+}
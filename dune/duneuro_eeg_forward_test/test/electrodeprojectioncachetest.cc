@@ -0,0 +1,114 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/electrode_projection_cache.hh>
+
+namespace {
+  const std::string cache_filename = "electrodeprojectioncachetest.cache";
+
+  // projection onto a fake mesh, the vertices depend on the mesh hash so that mixed up entries are detected
+  std::vector<std::size_t> fake_projection(std::uint64_t mesh_hash, std::size_t number_of_electrodes)
+  {
+    std::vector<std::size_t> vertices(number_of_electrodes);
+    for(std::size_t i = 0; i < vertices.size(); ++i) {
+      vertices[i] = 1000 * mesh_hash + i;
+    }
+    return vertices;
+  }
+
+  // load the projection of the electrodes onto the fake mesh, counting the projections computed
+  std::vector<std::size_t> load(std::uint64_t mesh_hash, const std::vector<std::array<double, 3>>& electrodes, bool& cache_hit, std::size_t& calls)
+  {
+    auto project = [mesh_hash, &calls] (const std::vector<std::array<double, 3>>& projected) {
+      ++calls;
+      return fake_projection(mesh_hash, projected.size());
+    };
+    return duneuro_eeg_forward_test::load_electrode_projection_with_cache(cache_filename, mesh_hash, electrodes, project, cache_hit);
+  }
+}
+
+// the levels of a convergence study alternate between meshes, all of them have to be served from the same file
+Dune::TestSuite test_several_meshes(const std::vector<std::array<double, 3>>& electrodes)
+{
+  Dune::TestSuite suite("several_meshes");
+  std::remove(cache_filename.c_str());
+  std::size_t calls = 0;
+  bool cache_hit;
+  for(int run = 0; run < 3; ++run) {
+    for(std::uint64_t mesh_hash : {11, 12, 13}) {
+      auto vertices = load(mesh_hash, electrodes, cache_hit, calls);
+      suite.check(cache_hit == (run > 0)) << "run " << run << " on mesh " << mesh_hash << (cache_hit ? " hit" : " missed") << " the cache";
+      suite.check(vertices == fake_projection(mesh_hash, electrodes.size())) << "wrong projection for mesh " << mesh_hash;
+    }
+  }
+  suite.check(calls == 3) << "projected " << calls << " times for 3 meshes";
+
+  // other electrodes on a known mesh are a new entry
+  std::vector<std::array<double, 3>> moved = electrodes;
+  moved[0][0] += 1.0;
+  load(12, moved, cache_hit, calls);
+  suite.check(!cache_hit) << "moved electrodes hit the cache";
+  load(12, electrodes, cache_hit, calls);
+  suite.check(cache_hit) << "adding an entry dropped an earlier one";
+  return suite;
+}
+
+// the oldest projections are dropped once the cache is full
+Dune::TestSuite test_eviction(const std::vector<std::array<double, 3>>& electrodes)
+{
+  Dune::TestSuite suite("eviction");
+  std::remove(cache_filename.c_str());
+  std::size_t calls = 0;
+  bool cache_hit;
+  const std::size_t entries = duneuro_eeg_forward_test::electrode_projection_cache_entries;
+  for(std::uint64_t mesh_hash = 0; mesh_hash <= entries; ++mesh_hash) {
+    load(mesh_hash, electrodes, cache_hit, calls);
+  }
+  suite.check(duneuro_eeg_forward_test::read_electrode_projection_cache(cache_filename).size() == entries);
+  load(entries, electrodes, cache_hit, calls);
+  suite.check(cache_hit) << "the newest projection was dropped";
+  load(0, electrodes, cache_hit, calls);
+  suite.check(!cache_hit) << "the oldest projection was kept";
+  return suite;
+}
+
+// a damaged cache is ignored and replaced
+Dune::TestSuite test_truncated(const std::vector<std::array<double, 3>>& electrodes)
+{
+  Dune::TestSuite suite("truncated");
+  std::remove(cache_filename.c_str());
+  std::size_t calls = 0;
+  bool cache_hit;
+  load(1, electrodes, cache_hit, calls);
+  load(2, electrodes, cache_hit, calls);
+  suite.require(::truncate(cache_filename.c_str(), sizeof(duneuro_eeg_forward_test::ElectrodeProjectionCacheHeader) + 20) == 0);
+  suite.check(duneuro_eeg_forward_test::read_electrode_projection_cache(cache_filename).empty()) << "a truncated cache was read";
+  auto vertices = load(1, electrodes, cache_hit, calls);
+  suite.check(!cache_hit && vertices.size() == electrodes.size());
+  load(1, electrodes, cache_hit, calls);
+  suite.check(cache_hit) << "the replaced cache was not used";
+  return suite;
+}
+
+int main()
+{
+  std::vector<std::array<double, 3>> electrodes = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {-1.0, 0.0, 0.0}};
+  Dune::TestSuite suite;
+  suite.subTest(test_several_meshes(electrodes));
+  suite.subTest(test_eviction(electrodes));
+  suite.subTest(test_truncated(electrodes));
+  std::remove(cache_filename.c_str());
+  return suite.exit();
+}
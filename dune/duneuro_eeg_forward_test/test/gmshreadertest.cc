@@ -0,0 +1,136 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/test/testsuite.hh>
+#include <dune/geometry/type.hh>
+#include <dune/grid/common/boundarysegment.hh>
+#include <dune/grid/io/file/gmshreader.hh>
+
+#include <dune/duneuro_eeg_forward_test/parallel_gmsh_reader.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+// grid type whose factory only records what the gmsh reader of dune-grid, which the driver uses, inserts
+struct RecordingGrid {
+  static constexpr int dimension = 3;
+  static constexpr int dimensionworld = 3;
+  using ctype = double;
+};
+
+namespace Dune {
+  template<>
+  class GridFactory<RecordingGrid> {
+  public:
+    void insertVertex(const FieldVector<double, 3>& position)
+    {
+      vertices.push_back({position[0], position[1], position[2]});
+    }
+
+    void insertElement(const GeometryType& type, const std::vector<unsigned int>& element)
+    {
+      if(type.isSimplex() && element.size() == 4) {
+        elements.push_back({element[0], element[1], element[2], element[3]});
+      }
+    }
+
+    void insertBoundarySegment(const std::vector<unsigned int>&)
+    {
+    }
+
+    void insertBoundarySegment(const std::vector<unsigned int>&, const std::shared_ptr<BoundarySegment<3, 3>>&)
+    {
+    }
+
+    std::vector<std::array<double, 3>> vertices;
+    std::vector<std::array<unsigned int, 4>> elements;
+  };
+}
+
+namespace {
+  // node ids are neither consecutive nor sorted, node 8 is unused and the triangle and the point are skipped by
+  // both readers. The reader of dune-grid numbers the vertices in the order the elements reference them, so the
+  // meshes are compared by the coordinates of the element vertices
+  const char* gmsh_file =
+    "$MeshFormat\n"
+    "2.2 0 8\n"
+    "$EndMeshFormat\n"
+    "$Nodes\n"
+    "7\n"
+    "5 0 0 0\n"
+    "2 1 0 0\n"
+    "9 0 1 0\n"
+    "1 0 0 1\n"
+    "8 7 7 7\n"
+    "3 1 1 1\n"
+    "4 -1 0.5 0.25\n"
+    "$EndNodes\n"
+    "$Elements\n"
+    "5\n"
+    "1 15 2 99 1 8\n"
+    "2 2 2 7 1 5 2 9\n"
+    "3 4 2 1 1 5 2 9 1\n"
+    "4 4 2 2 2 2 9 1 3\n"
+    "5 4 3 3 4 1 4 5 9 1\n"
+    "$EndElements\n";
+
+  using Element = std::array<std::array<double, 3>, 4>;
+
+  std::vector<Element> element_coordinates(const std::vector<std::array<double, 3>>& nodes,
+                                            const std::vector<std::array<unsigned int, 4>>& elements)
+  {
+    std::vector<Element> result;
+    for(const auto& element : elements) {
+      Element coordinates;
+      for(int i = 0; i < 4; ++i) {
+        coordinates[i] = nodes[element[i]];
+      }
+      result.push_back(coordinates);
+    }
+    return result;
+  }
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  const std::string filename = "gmshreadertest.msh";
+  {
+    std::ofstream out(filename);
+    out << gmsh_file;
+  }
+
+  Dune::GridFactory<RecordingGrid> factory;
+  std::vector<int> boundary_to_physical_entity;
+  std::vector<int> element_to_physical_entity;
+  Dune::GmshReader<RecordingGrid>::read(factory, filename, boundary_to_physical_entity, element_to_physical_entity, false, false);
+  auto expected_elements = element_coordinates(factory.vertices, factory.elements);
+  std::vector<std::size_t> expected_labels(element_to_physical_entity.begin(), element_to_physical_entity.end());
+  suite.require(expected_elements.size() == 3 && expected_labels.size() == 3) << "the reader of dune-grid found "
+                                                                               << expected_elements.size() << " tetrahedra";
+
+  auto check = [&] (const duneuro_eeg_forward_test::TetrahedralMesh& mesh, const std::string& name) {
+    suite.check(mesh.nodes.size() == 7) << name << " read " << mesh.nodes.size() << " nodes";
+    suite.check(element_coordinates(mesh.nodes, mesh.elements) == expected_elements) << name << " differs from the reader of dune-grid in the elements";
+    suite.check(mesh.labels == expected_labels) << name << " differs from the reader of dune-grid in the labels";
+  };
+  auto serial_mesh = duneuro_eeg_forward_test::read_gmsh(filename);
+  check(serial_mesh, "read_gmsh");
+  for(std::size_t threads : {1, 2, 3, 8}) {
+    auto parallel_mesh = duneuro_eeg_forward_test::read_gmsh_parallel(filename, threads);
+    check(parallel_mesh, "read_gmsh_parallel with " + std::to_string(threads) + " threads");
+    suite.check(parallel_mesh.nodes == serial_mesh.nodes && parallel_mesh.elements == serial_mesh.elements)
+      << "read_gmsh_parallel with " << threads << " threads differs from read_gmsh";
+  }
+
+  std::remove(filename.c_str());
+  return suite.exit();
+}
@@ -0,0 +1,110 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/p1_forward_solver.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace {
+  using Point = std::array<double, 3>;
+
+  // the affine image x -> A x + t of n x n x n cubes, each split into the 6 tetrahedra of the Kuhn triangulation.
+  // A is a shear with scaling, so that the elements are neither axis aligned nor of equal shape
+  duneuro_eeg_forward_test::TetrahedralMesh make_sheared_cube_mesh(unsigned int n)
+  {
+    const double A[3][3] = {{1.3, 0.4, -0.2}, {0.0, 0.7, 0.5}, {0.1, 0.0, 2.1}};
+    const Point t = {-4.0, 2.5, 10.0};
+    duneuro_eeg_forward_test::TetrahedralMesh mesh;
+    auto index = [n] (unsigned int i, unsigned int j, unsigned int k) {return (k * (n + 1) + j) * (n + 1) + i;};
+    for(unsigned int k = 0; k <= n; ++k) {
+      for(unsigned int j = 0; j <= n; ++j) {
+        for(unsigned int i = 0; i <= n; ++i) {
+          Point x = {1.0 * i / n, 1.0 * j / n, 1.0 * k / n};
+          Point y;
+          for(int r = 0; r < 3; ++r) {
+            y[r] = A[r][0] * x[0] + A[r][1] * x[1] + A[r][2] * x[2] + t[r];
+          }
+          mesh.nodes.push_back(y);
+        }
+      }
+    }
+    std::array<unsigned int, 3> axes = {0, 1, 2};
+    for(unsigned int k = 0; k < n; ++k) {
+      for(unsigned int j = 0; j < n; ++j) {
+        for(unsigned int i = 0; i < n; ++i) {
+          std::sort(axes.begin(), axes.end());
+          do {
+            std::array<unsigned int, 3> corner = {i, j, k};
+            std::array<unsigned int, 4> element;
+            element[0] = index(corner[0], corner[1], corner[2]);
+            for(int step = 0; step < 3; ++step) {
+              ++corner[axes[step]];
+              element[step + 1] = index(corner[0], corner[1], corner[2]);
+            }
+            mesh.elements.push_back(element);
+            mesh.labels.push_back(1);
+          } while(std::next_permutation(axes.begin(), axes.end()));
+        }
+      }
+    }
+    return mesh;
+  }
+}
+
+// the P1 interpolant of a linear function u(x) = a . x + b is u itself, hence its gradient is a on every element,
+// independent of the orientation of the element and of the distribution of the elements over the threads
+Dune::TestSuite test_linear_field(const duneuro_eeg_forward_test::TetrahedralMesh& mesh, const Point& a, double b, std::size_t number_of_threads)
+{
+  Dune::TestSuite suite("linear_field_threads_" + std::to_string(number_of_threads));
+  std::vector<double> solution(mesh.nodes.size());
+  for(std::size_t i = 0; i < solution.size(); ++i) {
+    const Point& x = mesh.nodes[i];
+    solution[i] = a[0] * x[0] + a[1] * x[1] + a[2] * x[2] + b;
+  }
+  // a buffer of the wrong size from an earlier mesh has to be resized and completely overwritten
+  std::vector<double> gradients(5, 1e300);
+  duneuro_eeg_forward_test::compute_cell_gradients(mesh, solution, gradients, number_of_threads);
+  suite.require(gradients.size() == 3 * mesh.elements.size()) << "buffer of size " << gradients.size();
+  // the sum of the gradients of the basis functions only vanishes up to rounding, hence b enters the tolerance
+  double scale = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) + std::abs(b);
+  for(std::size_t e = 0; e < mesh.elements.size(); ++e) {
+    for(int i = 0; i < 3; ++i) {
+      suite.check(std::abs(gradients[3 * e + i] - a[i]) <= 1e-10 * scale)
+        << "component " << i << " of the gradient on element " << e << " is " << gradients[3 * e + i] << " instead of " << a[i];
+    }
+  }
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  // 12^3 cubes are 10368 elements, several chunks of the parallel loop
+  auto mesh = make_sheared_cube_mesh(12);
+  const Point a = {0.75, -2.0, 3.5};
+  for(std::size_t threads : {1, 2, 3, 8}) {
+    suite.subTest(test_linear_field(mesh, a, -1.25, threads));
+  }
+  // a constant field has no gradient
+  suite.subTest(test_linear_field(mesh, {0.0, 0.0, 0.0}, 4.0, 4));
+
+  bool thrown = false;
+  try {
+    duneuro_eeg_forward_test::compute_cell_gradients(mesh, std::vector<double>(mesh.nodes.size() - 1), 2);
+  }
+  catch(Dune::RangeError&) {
+    thrown = true;
+  }
+  suite.check(thrown) << "a solution of the wrong size was accepted";
+  return suite.exit();
+}
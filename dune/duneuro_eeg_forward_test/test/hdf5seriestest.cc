@@ -0,0 +1,148 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/hdf5_series_writer.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace {
+  const std::string filename = "hdf5seriestest";
+
+  std::size_t count(const std::string& content, const std::string& pattern)
+  {
+    std::size_t n = 0;
+    for(auto position = content.find(pattern); position != std::string::npos; position = content.find(pattern, position + 1)) {
+      ++n;
+    }
+    return n;
+  }
+
+  // read a whole dataset, returns false if it does not exist or has a different number of entries
+  template<class T>
+  bool read_dataset(hid_t file, const std::string& name, hid_t type, std::vector<T>& values, std::size_t size)
+  {
+    if(H5Lexists(file, name.c_str(), H5P_DEFAULT) <= 0) {
+      return false;
+    }
+    hid_t dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+    hid_t space = H5Dget_space(dataset);
+    bool matches = H5Sget_simple_extent_npoints(space) == static_cast<hssize_t>(size);
+    H5Sclose(space);
+    values.assign(size, T());
+    if(matches) {
+      matches = H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data()) >= 0;
+    }
+    H5Dclose(dataset);
+    return matches;
+  }
+
+  // two tetrahedra sharing a face, and some unused vertices
+  duneuro_eeg_forward_test::TetrahedralMesh make_mesh()
+  {
+    duneuro_eeg_forward_test::TetrahedralMesh mesh;
+    mesh.nodes = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0, 1.0}};
+    for(std::size_t i = 0; i < 30; ++i) {
+      mesh.nodes.push_back({0.5 * i, 0.25 * i, -1.0 * i});
+    }
+    mesh.elements = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+    mesh.labels = {3, 7};
+    return mesh;
+  }
+}
+
+// the mesh and the solution of every step are read back from the HDF5 file and compared to the written data. The
+// XDMF descriptor has to define the mesh once and refer to it from every step
+Dune::TestSuite test_round_trip(int compression_level, std::size_t chunk_rows)
+{
+  Dune::TestSuite suite("level_" + std::to_string(compression_level) + "_chunk_rows_" + std::to_string(chunk_rows));
+  auto mesh = make_mesh();
+  const std::vector<std::size_t> steps = {0, 3, 4};
+  auto potential = [&] (std::size_t step) {
+    std::vector<double> values(mesh.nodes.size());
+    for(std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = 0.1 * i - 3.0 * step;
+    }
+    return values;
+  };
+  auto gradient = [&] (std::size_t step) {
+    std::vector<double> values(3 * mesh.elements.size());
+    for(std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = step + 1.0 / (i + 1.0);
+    }
+    return values;
+  };
+  {
+    duneuro_eeg_forward_test::Hdf5SeriesWriter writer(mesh, filename, compression_level, chunk_rows);
+    for(std::size_t step : steps) {
+      writer.add_step(step, potential(step), gradient(step));
+    }
+  }
+
+  hid_t file = H5Fopen((filename + ".h5").c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  suite.require(file >= 0) << "could not open " << filename << ".h5";
+  std::vector<double> coordinates;
+  suite.check(read_dataset(file, "/mesh/coordinates", H5T_NATIVE_DOUBLE, coordinates, 3 * mesh.nodes.size()));
+  for(std::size_t i = 0; i < mesh.nodes.size(); ++i) {
+    for(std::size_t j = 0; j < 3; ++j) {
+      suite.check(coordinates[3 * i + j] == mesh.nodes[i][j]) << "coordinate " << j << " of vertex " << i << " does not match";
+    }
+  }
+  std::vector<std::int64_t> topology;
+  suite.check(read_dataset(file, "/mesh/topology", H5T_NATIVE_INT64, topology, 4 * mesh.elements.size()));
+  for(std::size_t i = 0; i < mesh.elements.size(); ++i) {
+    for(std::size_t j = 0; j < 4; ++j) {
+      suite.check(topology[4 * i + j] == static_cast<std::int64_t>(mesh.elements[i][j])) << "vertex " << j << " of element " << i << " does not match";
+    }
+  }
+  std::vector<std::int32_t> labels;
+  suite.check(read_dataset(file, "/mesh/label", H5T_NATIVE_INT32, labels, mesh.elements.size()));
+  suite.check(labels == std::vector<std::int32_t>(mesh.labels.begin(), mesh.labels.end())) << "labels do not match";
+  for(std::size_t step : steps) {
+    std::vector<double> values;
+    suite.check(read_dataset(file, "/potential/" + std::to_string(step), H5T_NATIVE_DOUBLE, values, mesh.nodes.size())
+                && values == potential(step)) << "potential of step " << step << " does not match";
+    suite.check(read_dataset(file, "/gradient/" + std::to_string(step), H5T_NATIVE_DOUBLE, values, 3 * mesh.elements.size())
+                && values == gradient(step)) << "gradient of step " << step << " does not match";
+  }
+  H5Fclose(file);
+
+  std::ifstream in(filename + ".xmf");
+  std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  suite.require(!content.empty()) << "could not read " << filename << ".xmf";
+  for(const std::string path : {"/mesh/topology", "/mesh/coordinates", "/mesh/label"}) {
+    suite.check(count(content, ":" + path + "<") == 1) << path << " is not described exactly once";
+  }
+  suite.check(count(content, "Reference=\"XML\"") == 3 * steps.size()) << "not every step refers to the mesh";
+  suite.check(count(content, "<Time Value=") == steps.size());
+  for(std::size_t step : steps) {
+    suite.check(count(content, ":/potential/" + std::to_string(step) + "<") == 1) << "potential of step " << step << " is not described";
+    suite.check(count(content, ":/gradient/" + std::to_string(step) + "<") == 1) << "gradient of step " << step << " is not described";
+  }
+  std::remove((filename + ".h5").c_str());
+  std::remove((filename + ".xmf").c_str());
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  suite.subTest(test_round_trip(0, 1 << 14));
+  // chunks smaller than the datasets, with a partial last chunk
+  suite.subTest(test_round_trip(0, 4));
+  if(H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+    suite.subTest(test_round_trip(6, 4));
+  }
+  return suite.exit();
+}
@@ -0,0 +1,118 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/kd_tree.hh>
+
+namespace {
+  using Point = std::array<double, 3>;
+
+  double squared_distance(const Point& a, const Point& b)
+  {
+    return (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]);
+  }
+
+  std::size_t brute_force_nearest(const std::vector<Point>& points, const Point& position)
+  {
+    std::size_t best = 0;
+    double best_distance = std::numeric_limits<double>::max();
+    for(std::size_t i = 0; i < points.size(); ++i) {
+      double distance = squared_distance(points[i], position);
+      if(distance < best_distance) {
+        best_distance = distance;
+        best = i;
+      }
+    }
+    return best;
+  }
+
+  std::vector<Point> random_points(std::size_t count, double low, double high, std::mt19937& generator)
+  {
+    std::uniform_real_distribution<double> coordinate(low, high);
+    std::vector<Point> points(count);
+    for(auto& point : points) {
+      point = {coordinate(generator), coordinate(generator), coordinate(generator)};
+    }
+    return points;
+  }
+}
+
+// the k-d tree has to find a point as close as the one found by a linear search, for queries inside and outside of
+// the point cloud. Points at the same distance may be reported in a different order, hence the distances are compared
+Dune::TestSuite test_against_brute_force(const std::string& name, const std::vector<Point>& points, const std::vector<Point>& queries)
+{
+  Dune::TestSuite suite("kd_tree_" + name);
+  duneuro_eeg_forward_test::KdTree tree(points);
+  suite.require(tree.size() == points.size());
+  for(std::size_t q = 0; q < queries.size(); ++q) {
+    std::size_t found = tree.nearest(queries[q]);
+    suite.require(found < points.size()) << "query " << q << " returned index " << found;
+    std::size_t expected = brute_force_nearest(points, queries[q]);
+    suite.check(squared_distance(points[found], queries[q]) == squared_distance(points[expected], queries[q]))
+      << "query " << q << " found point " << found << " instead of " << expected;
+  }
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  std::mt19937 generator(1234);
+
+  // queries inside the cloud and far outside of it
+  std::vector<Point> queries = random_points(500, -2.0, 2.0, generator);
+  auto outside = random_points(100, -50.0, 50.0, generator);
+  queries.insert(queries.end(), outside.begin(), outside.end());
+
+  // sizes below, at and above a leaf
+  for(std::size_t count : {1, 7, 8, 9, 100, 20000}) {
+    suite.subTest(test_against_brute_force("uniform_" + std::to_string(count), random_points(count, -1.0, 1.0, generator), queries));
+  }
+
+  // vertices of a regular grid contain many points at the same distance and coordinates equal to the split value
+  std::vector<Point> grid;
+  for(int i = 0; i < 12; ++i) {
+    for(int j = 0; j < 12; ++j) {
+      for(int k = 0; k < 12; ++k) {
+        grid.push_back({i / 6.0 - 1.0, j / 6.0 - 1.0, k / 6.0 - 1.0});
+      }
+    }
+  }
+  std::vector<Point> grid_queries = queries;
+  grid_queries.insert(grid_queries.end(), grid.begin(), grid.end());
+  suite.subTest(test_against_brute_force("grid", grid, grid_queries));
+
+  // points on a thin shell as the vertices of a head surface, and duplicated points
+  std::vector<Point> shell;
+  std::normal_distribution<double> normal;
+  for(std::size_t i = 0; i < 5000; ++i) {
+    Point direction = {normal(generator), normal(generator), normal(generator)};
+    double length = std::sqrt(squared_distance(direction, {0.0, 0.0, 0.0}));
+    shell.push_back({direction[0] / length, direction[1] / length, direction[2] / length});
+  }
+  suite.subTest(test_against_brute_force("shell", shell, queries));
+  std::vector<Point> duplicated = random_points(50, -1.0, 1.0, generator);
+  duplicated.insert(duplicated.end(), duplicated.begin(), duplicated.end());
+  suite.subTest(test_against_brute_force("duplicated", duplicated, queries));
+
+  bool thrown = false;
+  try {
+    duneuro_eeg_forward_test::KdTree().nearest({0.0, 0.0, 0.0});
+  }
+  catch(Dune::RangeError&) {
+    thrown = true;
+  }
+  suite.check(thrown) << "query in an empty tree did not throw";
+  return suite.exit();
+}
@@ -0,0 +1,98 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/hash.hh>
+#include <dune/duneuro_eeg_forward_test/mesh_cache.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace {
+  const std::string mesh_filename = "meshcachetest.msh";
+  const std::string cache_filename = "meshcachetest.msh.cache";
+
+  void write_file(const std::string& content)
+  {
+    std::ofstream out(mesh_filename);
+    out << content;
+  }
+
+  // set the modification time of the mesh file to the given number of seconds
+  void set_mtime(long seconds)
+  {
+    struct timespec times[2] = {{seconds, 0}, {seconds, 0}};
+    ::utimensat(AT_FDCWD, mesh_filename.c_str(), times, 0);
+  }
+
+  bool equal(const duneuro_eeg_forward_test::TetrahedralMesh& a, const duneuro_eeg_forward_test::TetrahedralMesh& b)
+  {
+    return a.nodes == b.nodes && a.elements == b.elements && a.labels == b.labels;
+  }
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+
+  // the content of the mesh file is not parsed, parse returns this mesh and counts its calls
+  duneuro_eeg_forward_test::TetrahedralMesh mesh;
+  mesh.nodes = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0, 1.0}};
+  mesh.elements = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+  mesh.labels = {3, 1ul << 40};
+  int parse_calls = 0;
+  auto parse = [&] (const std::string&) {
+    ++parse_calls;
+    return mesh;
+  };
+
+  std::remove(cache_filename.c_str());
+  write_file("first content");
+  set_mtime(1000000);
+  bool cache_hit;
+  std::uint64_t mesh_hash;
+  auto loaded = duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, mesh_hash);
+  suite.check(!cache_hit && parse_calls == 1) << "the first load has to parse the mesh";
+  suite.check(equal(loaded, mesh)) << "the parsed mesh is not returned";
+  suite.check(mesh_hash == duneuro_eeg_forward_test::hash_file(mesh_filename)) << "mesh_hash is not the hash of the file";
+
+  loaded = {};
+  loaded = duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, mesh_hash);
+  suite.check(cache_hit && parse_calls == 1) << "the unchanged file has to be loaded from the cache";
+  suite.check(equal(loaded, mesh)) << "the mesh read from the cache differs from the parsed one";
+  suite.check(mesh_hash == duneuro_eeg_forward_test::hash_file(mesh_filename)) << "mesh_hash of a cache hit is not the hash of the file";
+
+  // a new modification time with the same content is detected by the hash, the cache is kept and updated
+  set_mtime(2000000);
+  duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, mesh_hash);
+  suite.check(cache_hit && parse_calls == 1) << "a new modification time alone must not invalidate the cache";
+  auto source = duneuro_eeg_forward_test::mesh_source_status(mesh_filename);
+  bool updated = duneuro_eeg_forward_test::read_mesh_cache(cache_filename, [&source] (const duneuro_eeg_forward_test::MeshCacheHeader& header) {
+      return header.source_mtime_ns == source.mtime_ns;
+    }, loaded);
+  suite.check(updated) << "the cache was not updated with the new modification time";
+
+  // new content of the same size invalidates the cache
+  write_file("other content");
+  set_mtime(3000000);
+  duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, mesh_hash);
+  suite.check(!cache_hit && parse_calls == 2) << "changed content has to be parsed again";
+  suite.check(mesh_hash == duneuro_eeg_forward_test::hash_file(mesh_filename)) << "mesh_hash is not the hash of the changed file";
+
+  // a truncated cache is ignored
+  ::truncate(cache_filename.c_str(), sizeof(duneuro_eeg_forward_test::MeshCacheHeader) + 8);
+  loaded = duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, mesh_hash);
+  suite.check(!cache_hit && parse_calls == 3 && equal(loaded, mesh)) << "a truncated cache has to be replaced";
+
+  std::remove(cache_filename.c_str());
+  std::remove(mesh_filename.c_str());
+  return suite.exit();
+}
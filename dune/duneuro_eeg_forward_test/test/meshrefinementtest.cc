@@ -0,0 +1,155 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/mesh_refinement.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace {
+  using Face = std::array<unsigned int, 3>;
+
+  double signed_volume(const duneuro_eeg_forward_test::TetrahedralMesh& mesh, const std::array<unsigned int, 4>& element)
+  {
+    return duneuro_eeg_forward_test::refinement_detail::orientation(mesh, element) / 6.0;
+  }
+
+  // n x n x n cubes, each split into the 6 tetrahedra of the Kuhn triangulation, which is conforming across the cubes.
+  // Every element is positively oriented and labeled by the cube it belongs to
+  duneuro_eeg_forward_test::TetrahedralMesh make_cube_mesh(unsigned int n)
+  {
+    duneuro_eeg_forward_test::TetrahedralMesh mesh;
+    auto index = [n] (unsigned int i, unsigned int j, unsigned int k) {return (k * (n + 1) + j) * (n + 1) + i;};
+    for(unsigned int k = 0; k <= n; ++k) {
+      for(unsigned int j = 0; j <= n; ++j) {
+        for(unsigned int i = 0; i <= n; ++i) {
+          mesh.nodes.push_back({1.0 * i, 1.0 * j, 1.0 * k});
+        }
+      }
+    }
+    std::array<unsigned int, 3> axes = {0, 1, 2};
+    for(unsigned int k = 0; k < n; ++k) {
+      for(unsigned int j = 0; j < n; ++j) {
+        for(unsigned int i = 0; i < n; ++i) {
+          std::sort(axes.begin(), axes.end());
+          do {
+            std::array<unsigned int, 3> corner = {i, j, k};
+            std::array<unsigned int, 4> element;
+            element[0] = index(corner[0], corner[1], corner[2]);
+            for(int step = 0; step < 3; ++step) {
+              ++corner[axes[step]];
+              element[step + 1] = index(corner[0], corner[1], corner[2]);
+            }
+            if(signed_volume(mesh, element) < 0.0) {
+              std::swap(element[2], element[3]);
+            }
+            mesh.elements.push_back(element);
+            mesh.labels.push_back((k * n + j) * n + i);
+          } while(std::next_permutation(axes.begin(), axes.end()));
+        }
+      }
+    }
+    return mesh;
+  }
+
+  // number of elements containing every face, the vertices of a face are sorted
+  std::map<Face, std::size_t> count_faces(const duneuro_eeg_forward_test::TetrahedralMesh& mesh)
+  {
+    std::map<Face, std::size_t> faces;
+    for(const auto& element : mesh.elements) {
+      for(int omit = 0; omit < 4; ++omit) {
+        Face face;
+        int position = 0;
+        for(int v = 0; v < 4; ++v) {
+          if(v != omit) {
+            face[position++] = element[v];
+          }
+        }
+        std::sort(face.begin(), face.end());
+        ++faces[face];
+      }
+    }
+    return faces;
+  }
+
+  std::size_t count_edges(const duneuro_eeg_forward_test::TetrahedralMesh& mesh)
+  {
+    std::set<std::pair<unsigned int, unsigned int>> edges;
+    for(const auto& element : mesh.elements) {
+      for(int a = 0; a < 4; ++a) {
+        for(int b = a + 1; b < 4; ++b) {
+          edges.emplace(std::min(element[a], element[b]), std::max(element[a], element[b]));
+        }
+      }
+    }
+    return edges.size();
+  }
+}
+
+// the refined mesh has to be conforming, i.e. every face is shared by two elements or lies on the boundary, whose
+// faces are split into four. The children cover their parent, inherit its label and keep its orientation
+Dune::TestSuite test_refinement(const duneuro_eeg_forward_test::TetrahedralMesh& mesh)
+{
+  Dune::TestSuite suite("refine_uniformly");
+  auto refined = duneuro_eeg_forward_test::refine_uniformly(mesh);
+
+  suite.check(refined.elements.size() == 8 * mesh.elements.size()) << "refinement created " << refined.elements.size() << " elements";
+  suite.check(refined.labels.size() == refined.elements.size());
+  suite.check(refined.nodes.size() == mesh.nodes.size() + count_edges(mesh)) << "expected a new vertex per edge";
+  suite.check(std::equal(mesh.nodes.begin(), mesh.nodes.end(), refined.nodes.begin())) << "coarse vertices were renumbered";
+
+  for(std::size_t e = 0; e < mesh.elements.size(); ++e) {
+    double parent_volume = signed_volume(mesh, mesh.elements[e]);
+    double children_volume = 0.0;
+    for(std::size_t c = 8 * e; c < 8 * e + 8; ++c) {
+      double volume = signed_volume(refined, refined.elements[c]);
+      suite.check((volume > 0.0) == (parent_volume > 0.0)) << "child " << c << " does not keep the orientation of its parent";
+      children_volume += volume;
+      suite.check(refined.labels[c] == mesh.labels[e]) << "child " << c << " does not inherit the label of its parent";
+    }
+    suite.check(std::abs(children_volume - parent_volume) <= 1e-12 * std::abs(parent_volume))
+      << "children of element " << e << " have volume " << children_volume << " instead of " << parent_volume;
+  }
+
+  auto coarse_faces = count_faces(mesh);
+  auto refined_faces = count_faces(refined);
+  std::size_t coarse_boundary = 0;
+  for(const auto& face : coarse_faces) {
+    coarse_boundary += face.second == 1;
+  }
+  std::size_t refined_boundary = 0;
+  for(const auto& face : refined_faces) {
+    suite.check(face.second <= 2) << "face shared by " << face.second << " elements";
+    refined_boundary += face.second == 1;
+  }
+  suite.check(refined_boundary == 4 * coarse_boundary)
+    << refined_boundary << " boundary faces after refinement, expected " << 4 * coarse_boundary;
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+
+  auto cubes = make_cube_mesh(2);
+  suite.subTest(test_refinement(cubes));
+  suite.subTest(test_refinement(duneuro_eeg_forward_test::refine_uniformly(cubes)));
+
+  // a negatively oriented element keeps its orientation
+  duneuro_eeg_forward_test::TetrahedralMesh single;
+  single.nodes = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+  single.elements = {{0, 1, 3, 2}};
+  single.labels = {5};
+  suite.subTest(test_refinement(single));
+  return suite.exit();
+}
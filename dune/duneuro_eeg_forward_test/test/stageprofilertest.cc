@@ -0,0 +1,61 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/stage_profiler.hh>
+
+int main()
+{
+  Dune::TestSuite suite;
+  duneuro_eeg_forward_test::StageProfiler profiler;
+  {
+    auto stage = profiler.scope("setup", duneuro_eeg_forward_test::StageProfiler::record_memory);
+  }
+
+  // the threads enter the stages in different orders, the report keeps the order of the first entry overall
+  constexpr std::size_t number_of_threads = 4;
+  constexpr std::size_t calls_per_thread = 1000;
+  {
+    auto stage = profiler.scope("solve");
+  }
+  std::vector<std::thread> threads;
+  for(std::size_t t = 0; t < number_of_threads; ++t) {
+    threads.emplace_back([&profiler, t] () {
+      for(std::size_t i = 0; i < calls_per_thread; ++i) {
+        if(t % 2 == 0) {
+          auto outer = profiler.scope("metrics");
+          auto inner = profiler.scope("solve");
+        }
+        else {
+          auto outer = profiler.scope("solve");
+          auto inner = profiler.scope("metrics");
+        }
+      }
+    });
+  }
+  for(auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stages = profiler.stages();
+  suite.require(stages.size() == 3) << "expected 3 stages, got " << stages.size();
+  suite.check(stages[0].name == "setup" && stages[1].name == "solve" && stages[2].name == "metrics") << "stages are not in the order of their first entry";
+  suite.check(stages[0].calls == 1 && stages[0].peak_rss_kb > 0) << "setup has to record one call and its memory";
+  suite.check(stages[1].calls == 1 + number_of_threads * calls_per_thread) << "solve has " << stages[1].calls << " calls";
+  suite.check(stages[2].calls == number_of_threads * calls_per_thread) << "metrics has " << stages[2].calls << " calls";
+  suite.check(stages[1].peak_rss_kb == -1 && stages[2].peak_rss_kb == -1) << "memory recorded for stages entered without record_memory";
+
+  // a second profiler does not see the stages of the first one, even on threads that recorded into both
+  duneuro_eeg_forward_test::StageProfiler other;
+  {
+    auto stage = other.scope("solve");
+  }
+  suite.check(other.stages().size() == 1 && other.stages()[0].calls == 1) << "profilers share their stages";
+  return suite.exit();
+}
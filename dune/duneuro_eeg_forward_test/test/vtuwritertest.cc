@@ -0,0 +1,187 @@
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+#include <dune/duneuro_eeg_forward_test/vtu_writer.hh>
+
+namespace {
+  const std::string filename = "vtuwritertest";
+
+  // a data array as found in the XML part of the file
+  struct ArrayHeader {
+    std::string type;
+    std::uint64_t offset;
+  };
+
+  std::uint64_t read_uint64(const std::string& content, std::size_t position)
+  {
+    std::uint64_t value;
+    std::memcpy(&value, content.data() + position, sizeof(value));
+    return value;
+  }
+
+  template<class T>
+  std::vector<char> to_bytes(const std::vector<T>& values)
+  {
+    std::vector<char> bytes(values.size() * sizeof(T));
+    std::memcpy(bytes.data(), values.data(), bytes.size());
+    return bytes;
+  }
+
+  // two tetrahedra sharing a face, with an optional number of unused vertices
+  duneuro_eeg_forward_test::TetrahedralMesh make_mesh(std::size_t extra_vertices, bool with_elements)
+  {
+    duneuro_eeg_forward_test::TetrahedralMesh mesh;
+    mesh.nodes = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0, 1.0}};
+    for(std::size_t i = 0; i < extra_vertices; ++i) {
+      mesh.nodes.push_back({0.5 * i, 0.25 * i, -1.0 * i});
+    }
+    if(with_elements) {
+      mesh.elements = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+      mesh.labels = {3, 7};
+    }
+    return mesh;
+  }
+}
+
+// decodes the appended section according to the header of every array, i.e. the number of bytes without
+// compression, or the number of blocks, the block size, the size of a partial last block and the compressed block
+// sizes with compression, and compares the decoded bytes to the expected content of every array
+Dune::TestSuite test_round_trip(const duneuro_eeg_forward_test::TetrahedralMesh& mesh,
+                                duneuro_eeg_forward_test::VtuCompression compression,
+                                std::size_t block_size,
+                                std::size_t number_of_threads)
+{
+  bool compressed = compression == duneuro_eeg_forward_test::VtuCompression::zlib;
+  Dune::TestSuite suite(std::string(compressed ? "zlib" : "raw") + "_block_size_" + std::to_string(block_size));
+
+  std::vector<double> potential(mesh.nodes.size());
+  for(std::size_t i = 0; i < potential.size(); ++i) {
+    potential[i] = 0.1 * i - 3.0;
+  }
+  std::vector<double> gradient(3 * mesh.elements.size());
+  for(std::size_t i = 0; i < gradient.size(); ++i) {
+    gradient[i] = 1.0 / (i + 1.0);
+  }
+  duneuro_eeg_forward_test::VtuWriter writer(mesh);
+  writer.add_vertex_data("potential", potential);
+  writer.add_cell_data("gradient", gradient, 3);
+  writer.write(filename, compression, number_of_threads, block_size, 6);
+
+  std::map<std::string, std::vector<char>> expected;
+  expected["potential"] = to_bytes(potential);
+  expected["gradient"] = to_bytes(gradient);
+  expected["label"] = to_bytes(std::vector<std::int32_t>(mesh.labels.begin(), mesh.labels.end()));
+  expected["Points"] = to_bytes(mesh.nodes);
+  std::vector<std::int64_t> connectivity, offsets;
+  for(const auto& element : mesh.elements) {
+    connectivity.insert(connectivity.end(), element.begin(), element.end());
+    offsets.push_back(connectivity.size());
+  }
+  expected["connectivity"] = to_bytes(connectivity);
+  expected["offsets"] = to_bytes(offsets);
+  expected["types"] = to_bytes(std::vector<std::uint8_t>(mesh.elements.size(), 10));
+
+  std::ifstream in(filename + ".vtu", std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  suite.require(!content.empty()) << "could not read " << filename << ".vtu";
+  suite.check((content.find("compressor=\"vtkZLibDataCompressor\"") != std::string::npos) == compressed)
+    << "compressor attribute does not match the compression";
+  suite.check(content.find("header_type=\"UInt64\"") != std::string::npos);
+
+  // the points array is the only one without a name
+  std::map<std::string, ArrayHeader> headers;
+  std::regex data_array("<DataArray type=\"(\\w+)\"(?: Name=\"(\\w+)\")? NumberOfComponents=\"\\d+\" format=\"appended\" offset=\"(\\d+)\"/>");
+  std::size_t xml_end = content.find("<AppendedData");
+  std::string xml = content.substr(0, xml_end);
+  for(auto it = std::sregex_iterator(xml.begin(), xml.end(), data_array); it != std::sregex_iterator(); ++it) {
+    std::string name = (*it)[2].matched ? (*it)[2].str() : "Points";
+    headers[name] = {(*it)[1].str(), std::stoull((*it)[3].str())};
+  }
+  suite.require(headers.size() == expected.size()) << "found " << headers.size() << " data arrays";
+
+  std::size_t appended = content.find('_', xml_end);
+  suite.require(appended != std::string::npos) << "appended section not found";
+  ++appended;
+  std::uint64_t end_of_data = 0;
+  for(const auto& entry : expected) {
+    const std::string& name = entry.first;
+    auto header = headers.find(name);
+    suite.require(header != headers.end()) << "array " << name << " not found";
+    std::size_t position = appended + header->second.offset;
+    std::vector<char> decoded;
+    if(!compressed) {
+      std::uint64_t size = read_uint64(content, position);
+      position += sizeof(std::uint64_t);
+      decoded.assign(content.begin() + position, content.begin() + position + size);
+      position += size;
+    }
+    else {
+#if HAVE_ZLIB
+      std::uint64_t number_of_blocks = read_uint64(content, position);
+      std::uint64_t stored_block_size = read_uint64(content, position + 8);
+      std::uint64_t last_block_size = read_uint64(content, position + 16);
+      suite.check(stored_block_size == block_size) << "array " << name << " has block size " << stored_block_size;
+      std::size_t uncompressed_size = entry.second.size();
+      std::size_t expected_blocks = (uncompressed_size + block_size - 1) / block_size;
+      suite.check(number_of_blocks == expected_blocks) << "array " << name << " has " << number_of_blocks << " blocks instead of " << expected_blocks;
+      suite.check(last_block_size == uncompressed_size % block_size)
+        << "array " << name << " reports a last block of " << last_block_size << " bytes";
+      std::size_t compressed_position = position + 24 + 8 * number_of_blocks;
+      for(std::uint64_t b = 0; b < number_of_blocks; ++b) {
+        std::uint64_t compressed_size = read_uint64(content, position + 24 + 8 * b);
+        // every block but a partial last one holds block_size bytes
+        uLongf size = (b + 1 == number_of_blocks && last_block_size != 0) ? last_block_size : stored_block_size;
+        std::vector<char> block(size);
+        int status = uncompress(reinterpret_cast<Bytef*>(block.data()), &size,
+                                reinterpret_cast<const Bytef*>(content.data() + compressed_position), compressed_size);
+        suite.check(status == Z_OK && size == block.size()) << "block " << b << " of array " << name << " could not be decompressed";
+        decoded.insert(decoded.end(), block.begin(), block.begin() + size);
+        compressed_position += compressed_size;
+      }
+      position = compressed_position;
+#endif
+    }
+    suite.check(decoded == entry.second) << "array " << name << " does not match its data";
+    end_of_data = std::max<std::uint64_t>(end_of_data, position);
+  }
+  suite.check(content.compare(end_of_data, 2, "\n ") == 0) << "the appended section does not end after the last array";
+  std::remove((filename + ".vtu").c_str());
+  return suite;
+}
+
+int main()
+{
+  Dune::TestSuite suite;
+  std::vector<duneuro_eeg_forward_test::VtuCompression> compressions = {duneuro_eeg_forward_test::VtuCompression::none};
+#if HAVE_ZLIB
+  compressions.push_back(duneuro_eeg_forward_test::VtuCompression::zlib);
+#endif
+  for(auto compression : compressions) {
+    // a block size of 40 leaves a partial last block for most arrays, 8 divides all arrays but the cell types
+    for(std::size_t block_size : {8, 40, 1 << 15}) {
+      suite.subTest(test_round_trip(make_mesh(20, true), compression, block_size, 3));
+    }
+    // a mesh without elements has empty cell arrays
+    suite.subTest(test_round_trip(make_mesh(0, false), compression, 40, 2));
+  }
+  return suite.exit();
+}
@@ -0,0 +1,106 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_TETRAHEDRAL_MESH_HH
+#define DUNEURO_EEG_FORWARD_TEST_TETRAHEDRAL_MESH_HH
+
+#include <array>
+#include <cstddef>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // labeled tetrahedral mesh, i.e. the information the fitted driver needs about the geometry of the volume conductor.
+  // elements store indices into nodes, labels[i] is the tissue label of elements[i]
+  struct TetrahedralMesh {
+    std::vector<std::array<double, 3>> nodes;
+    std::vector<std::array<unsigned int, 4>> elements;
+    std::vector<std::size_t> labels;
+  };
+
+  // gmsh element type of a 4-node tetrahedron
+  constexpr int gmsh_tetrahedron_type = 4;
+
+  // read an ASCII gmsh 2.2 file. Only tetrahedra are kept, their label is the physical entity tag.
+  // Node ids are mapped to consecutive indices in the order they appear in the file
+  inline TetrahedralMesh read_gmsh(const std::string& filename)
+  {
+    std::ifstream in(filename);
+    if(!in) {
+      DUNE_THROW(Dune::IOError, "could not open " << filename);
+    }
+
+    auto seek_section = [&in, &filename] (const std::string& section) {
+      std::string line;
+      while(std::getline(in, line)) {
+        if(line.compare(0, section.size(), section) == 0) {
+          return;
+        }
+      }
+      DUNE_THROW(Dune::IOError, "section " << section << " not found in " << filename);
+    };
+
+    TetrahedralMesh mesh;
+    constexpr unsigned int invalid_index = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> id_to_index;
+
+    seek_section("$Nodes");
+    std::size_t number_of_nodes;
+    in >> number_of_nodes;
+    mesh.nodes.resize(number_of_nodes);
+    for(std::size_t i = 0; i < number_of_nodes; ++i) {
+      std::size_t id;
+      in >> id >> mesh.nodes[i][0] >> mesh.nodes[i][1] >> mesh.nodes[i][2];
+      if(id >= id_to_index.size()) {
+        id_to_index.resize(id + 1, invalid_index);
+      }
+      id_to_index[id] = i;
+    }
+    if(!in) {
+      DUNE_THROW(Dune::IOError, "error while reading the nodes of " << filename);
+    }
+
+    seek_section("$Elements");
+    std::size_t number_of_elements;
+    in >> number_of_elements;
+    mesh.elements.reserve(number_of_elements);
+    mesh.labels.reserve(number_of_elements);
+    for(std::size_t i = 0; i < number_of_elements; ++i) {
+      int id, type, number_of_tags;
+      in >> id >> type >> number_of_tags;
+      std::size_t physical_tag = 0;
+      for(int t = 0; t < number_of_tags; ++t) {
+        std::size_t tag;
+        in >> tag;
+        if(t == 0) {
+          physical_tag = tag;
+        }
+      }
+      if(type != gmsh_tetrahedron_type) {
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        continue;
+      }
+      std::array<unsigned int, 4> element;
+      for(auto& vertex : element) {
+        std::size_t node_id;
+        in >> node_id;
+        if(node_id >= id_to_index.size() || id_to_index[node_id] == invalid_index) {
+          DUNE_THROW(Dune::IOError, "element " << id << " references unknown node " << node_id << " in " << filename);
+        }
+        vertex = id_to_index[node_id];
+      }
+      mesh.elements.push_back(element);
+      mesh.labels.push_back(physical_tag);
+    }
+    if(!in) {
+      DUNE_THROW(Dune::IOError, "error while reading the elements of " << filename);
+    }
+
+    return mesh;
+  }
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_TETRAHEDRAL_MESH_HH
@@ -0,0 +1,284 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_VTU_WRITER_HH
+#define DUNEURO_EEG_FORWARD_TEST_VTU_WRITER_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/parallel_for.hh>
+#include <dune/duneuro_eeg_forward_test/tetrahedral_mesh.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  enum class VtuCompression { none, zlib };
+
+  inline VtuCompression compression_from_string(const std::string& name)
+  {
+    if(name == "none") {
+      return VtuCompression::none;
+    }
+    if(name == "zlib") {
+#if HAVE_ZLIB
+      return VtuCompression::zlib;
+#else
+      DUNE_THROW(Dune::NotImplemented, "zlib compression requested, but zlib was not found when configuring");
+#endif
+    }
+    DUNE_THROW(Dune::Exception, "unknown compression " << name);
+  }
+
+  namespace vtu_detail {
+    template<class T>
+    const char* type_name();
+    template<> inline const char* type_name<double>() { return "Float64"; }
+    template<> inline const char* type_name<std::int32_t>() { return "Int32"; }
+    template<> inline const char* type_name<std::int64_t>() { return "Int64"; }
+    template<> inline const char* type_name<std::uint8_t>() { return "UInt8"; }
+
+    struct DataArray {
+      std::string name;
+      const char* type;
+      int components;
+      std::vector<char> bytes;
+    };
+
+    template<class T>
+    DataArray make_array(std::string name, int components, const std::vector<T>& values)
+    {
+      DataArray array{std::move(name), type_name<T>(), components, std::vector<char>(values.size() * sizeof(T))};
+      std::memcpy(array.bytes.data(), values.data(), array.bytes.size());
+      return array;
+    }
+
+    inline void append_uint64(std::vector<char>& buffer, std::uint64_t value)
+    {
+      const char* bytes = reinterpret_cast<const char*>(&value);
+      buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    }
+  } // namespace vtu_detail
+
+  // writer of a tetrahedral mesh with vertex and cell data in the VTK XML format (.vtu). All arrays are stored
+  // in the appended section as raw binary, which avoids the base64 encoding of the inline binary format. With
+  // zlib compression the arrays are split into blocks of block_size bytes which are compressed independently as
+  // the vtkZLibDataCompressor expects, distributed over number_of_threads threads. The compression level is 1 to
+  // 9 as for zlib, on a head model level 1 is about 3 times faster than the default 6 for 1.5% larger files.
+  // The element labels are written as cell data "label"
+  class VtuWriter {
+  public:
+    explicit VtuWriter(const TetrahedralMesh& mesh)
+      : mesh_(mesh)
+    {
+    }
+
+    void add_vertex_data(std::string name, const std::vector<double>& values, int components = 1)
+    {
+      check_size(name, values.size(), mesh_.nodes.size() * components);
+      vertex_data_.push_back(vtu_detail::make_array(std::move(name), components, values));
+    }
+
+    void add_cell_data(std::string name, const std::vector<double>& values, int components = 1)
+    {
+      check_size(name, values.size(), mesh_.elements.size() * components);
+      cell_data_.push_back(vtu_detail::make_array(std::move(name), components, values));
+    }
+
+    // write to filename.vtu
+    void write(const std::string& filename,
+               VtuCompression compression = VtuCompression::none,
+               std::size_t number_of_threads = 1,
+               std::size_t block_size = 1 << 15,
+               int level = 1) const
+    {
+      const std::uint32_t probe = 1;
+      if(*reinterpret_cast<const unsigned char*>(&probe) != 1) {
+        DUNE_THROW(Dune::NotImplemented, "raw binary VTU output is only implemented for little endian machines");
+      }
+
+      std::vector<vtu_detail::DataArray> label_data;
+      std::vector<std::int32_t> labels(mesh_.labels.begin(), mesh_.labels.end());
+      label_data.push_back(vtu_detail::make_array("label", 1, labels));
+      std::vector<vtu_detail::DataArray> points;
+      {
+        vtu_detail::DataArray array{"Points", "Float64", 3, std::vector<char>(mesh_.nodes.size() * 3 * sizeof(double))};
+        std::memcpy(array.bytes.data(), mesh_.nodes.data(), array.bytes.size());
+        points.push_back(std::move(array));
+      }
+      std::vector<vtu_detail::DataArray> cells;
+      {
+        std::vector<std::int64_t> connectivity;
+        connectivity.reserve(4 * mesh_.elements.size());
+        std::vector<std::int64_t> offsets;
+        offsets.reserve(mesh_.elements.size());
+        for(const auto& element : mesh_.elements) {
+          connectivity.insert(connectivity.end(), element.begin(), element.end());
+          offsets.push_back(connectivity.size());
+        }
+        // 10 is VTK_TETRA
+        std::vector<std::uint8_t> types(mesh_.elements.size(), 10);
+        cells.push_back(vtu_detail::make_array("connectivity", 1, connectivity));
+        cells.push_back(vtu_detail::make_array("offsets", 1, offsets));
+        cells.push_back(vtu_detail::make_array("types", 1, types));
+      }
+
+      // the arrays in the order of the appended section
+      std::vector<const vtu_detail::DataArray*> arrays;
+      using Group = const std::vector<vtu_detail::DataArray>*;
+      for(Group group : std::initializer_list<Group>{&vertex_data_, &label_data, &cell_data_, &points, &cells}) {
+        for(const auto& array : *group) {
+          arrays.push_back(&array);
+        }
+      }
+      std::vector<std::vector<char>> encoded = encode(arrays, compression, number_of_threads, block_size, level);
+
+      std::ofstream out(filename + ".vtu", std::ios::binary);
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "could not open " << filename << ".vtu");
+      }
+      std::uint64_t offset = 0;
+      std::size_t index = 0;
+      auto write_array_header = [&] (const vtu_detail::DataArray& array, bool named) {
+        out << "        <DataArray type=\"" << array.type << "\"";
+        if(named) {
+          out << " Name=\"" << array.name << "\"";
+        }
+        out << " NumberOfComponents=\"" << array.components << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+        offset += encoded[index++].size();
+      };
+
+      out << "<?xml version=\"1.0\"?>\n";
+      out << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+      if(compression == VtuCompression::zlib) {
+        out << " compressor=\"vtkZLibDataCompressor\"";
+      }
+      out << ">\n";
+      out << "  <UnstructuredGrid>\n";
+      out << "    <Piece NumberOfPoints=\"" << mesh_.nodes.size() << "\" NumberOfCells=\"" << mesh_.elements.size() << "\">\n";
+      out << "      <PointData>\n";
+      for(const auto& array : vertex_data_) {
+        write_array_header(array, true);
+      }
+      out << "      </PointData>\n";
+      out << "      <CellData>\n";
+      for(Group group : std::initializer_list<Group>{&label_data, &cell_data_}) {
+        for(const auto& array : *group) {
+          write_array_header(array, true);
+        }
+      }
+      out << "      </CellData>\n";
+      out << "      <Points>\n";
+      write_array_header(points[0], false);
+      out << "      </Points>\n";
+      out << "      <Cells>\n";
+      for(const auto& array : cells) {
+        write_array_header(array, true);
+      }
+      out << "      </Cells>\n";
+      out << "    </Piece>\n";
+      out << "  </UnstructuredGrid>\n";
+      out << "  <AppendedData encoding=\"raw\">\n";
+      out << "   _";
+      for(const auto& content : encoded) {
+        out.write(content.data(), content.size());
+      }
+      out << "\n  </AppendedData>\n";
+      out << "</VTKFile>\n";
+      if(!out) {
+        DUNE_THROW(Dune::IOError, "error while writing " << filename << ".vtu");
+      }
+    }
+
+  private:
+    void check_size(const std::string& name, std::size_t size, std::size_t expected) const
+    {
+      if(size != expected) {
+        DUNE_THROW(Dune::RangeError, "data " << name << " has " << size << " entries instead of " << expected);
+      }
+    }
+
+    // content of every array in the appended section, i.e. a header followed by the possibly compressed data. Without compression the header is the number of bytes. With
+    // compression it is the number of blocks, the uncompressed block size, the uncompressed size of the last
+    // block if it is partial and otherwise 0, and the compressed size of every block
+    static std::vector<std::vector<char>> encode(const std::vector<const vtu_detail::DataArray*>& arrays,
+                                                 VtuCompression compression,
+                                                 [[maybe_unused]] std::size_t number_of_threads,
+                                                 [[maybe_unused]] std::size_t block_size,
+                                                 [[maybe_unused]] int level)
+    {
+      std::vector<std::vector<char>> encoded(arrays.size());
+      if(compression == VtuCompression::none) {
+        for(std::size_t i = 0; i < arrays.size(); ++i) {
+          vtu_detail::append_uint64(encoded[i], arrays[i]->bytes.size());
+          encoded[i].insert(encoded[i].end(), arrays[i]->bytes.begin(), arrays[i]->bytes.end());
+        }
+        return encoded;
+      }
+#if HAVE_ZLIB
+      // the blocks of all arrays form a single list of tasks, so that small arrays do not limit the parallelism
+      struct Block {
+        const vtu_detail::DataArray* array;
+        std::size_t begin;
+        std::size_t size;
+        std::vector<char> compressed;
+      };
+      block_size = std::max<std::size_t>(block_size, 1);
+      std::vector<Block> blocks;
+      for(const auto* array : arrays) {
+        for(std::size_t begin = 0; begin < array->bytes.size(); begin += block_size) {
+          blocks.push_back({array, begin, std::min(block_size, array->bytes.size() - begin), {}});
+        }
+      }
+      parallel_for(blocks.size(), number_of_threads, 1, [&blocks, level] (std::size_t begin, std::size_t end) {
+        for(std::size_t b = begin; b < end; ++b) {
+          Block& block = blocks[b];
+          uLongf compressed_size = compressBound(block.size);
+          block.compressed.resize(compressed_size);
+          int status = compress2(reinterpret_cast<Bytef*>(block.compressed.data()), &compressed_size,
+                                 reinterpret_cast<const Bytef*>(block.array->bytes.data() + block.begin), block.size,
+                                 level);
+          if(status != Z_OK) {
+            DUNE_THROW(Dune::IOError, "zlib compression failed with status " << status);
+          }
+          block.compressed.resize(compressed_size);
+        }
+      });
+
+      auto block = blocks.begin();
+      for(std::size_t i = 0; i < arrays.size(); ++i) {
+        auto first = block;
+        while(block != blocks.end() && block->array == arrays[i]) {
+          ++block;
+        }
+        vtu_detail::append_uint64(encoded[i], block - first);
+        vtu_detail::append_uint64(encoded[i], block_size);
+        vtu_detail::append_uint64(encoded[i], arrays[i]->bytes.size() % block_size);
+        for(auto it = first; it != block; ++it) {
+          vtu_detail::append_uint64(encoded[i], it->compressed.size());
+        }
+        for(auto it = first; it != block; ++it) {
+          encoded[i].insert(encoded[i].end(), it->compressed.begin(), it->compressed.end());
+        }
+      }
+      return encoded;
+#else
+      DUNE_THROW(Dune::NotImplemented, "zlib compression requested, but zlib was not found when configuring");
+#endif
+    }
+
+    const TetrahedralMesh& mesh_;
+    std::vector<vtu_detail::DataArray> vertex_data_;
+    std::vector<vtu_detail::DataArray> cell_data_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_VTU_WRITER_HH
@@ -0,0 +1,118 @@
+#ifndef DUNEURO_EEG_FORWARD_TEST_WARM_START_HH
+#define DUNEURO_EEG_FORWARD_TEST_WARM_START_HH
+
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/duneuro_eeg_forward_test/conjugate_gradient.hh>
+#include <dune/duneuro_eeg_forward_test/sparse_matrix.hh>
+
+namespace duneuro_eeg_forward_test {
+
+  // initial guesses for a sequence of solves with the same matrix, e.g. for neighboring dipoles of a source space.
+  //   none : start from zero
+  //   previous : start from the solution of the last solve
+  //   projection : start from the Galerkin projection of the new problem onto the span of the last basis_size
+  //                solutions, i.e. the vector of this span with the smallest error in the energy norm.
+  //                The basis is kept orthonormal with respect to A, so the projection needs no dense solve
+  class WarmStart {
+  public:
+    enum class Strategy { none, previous, projection };
+
+    static Strategy strategy_from_string(const std::string& name)
+    {
+      if(name == "none") {
+        return Strategy::none;
+      }
+      if(name == "previous") {
+        return Strategy::previous;
+      }
+      if(name == "projection") {
+        return Strategy::projection;
+      }
+      DUNE_THROW(Dune::Exception, "unknown warm start strategy " << name);
+    }
+
+    explicit WarmStart(Strategy strategy = Strategy::none, std::size_t basis_size = 1)
+      : strategy_(strategy)
+      , basis_size_(basis_size)
+    {
+    }
+
+    // overwrite x with the initial guess for A x = b
+    void initial_guess(const std::vector<double>& b, std::vector<double>& x) const
+    {
+      x.assign(b.size(), 0.0);
+      if(strategy_ == Strategy::previous && !previous_.empty()) {
+        x = previous_;
+      }
+      else if(strategy_ == Strategy::projection) {
+        for(const auto& v : basis_) {
+          double coefficient = dot(v, b);
+          for(std::size_t i = 0; i < x.size(); ++i) {
+            x[i] += coefficient * v[i];
+          }
+        }
+      }
+    }
+
+    // store the solution x of a solve with matrix
+    void add_solution(const SparseMatrix<double>& matrix, const std::vector<double>& x)
+    {
+      if(strategy_ == Strategy::previous) {
+        previous_ = x;
+      }
+      else if(strategy_ == Strategy::projection && basis_size_ > 0) {
+        if(basis_.size() == basis_size_) {
+          basis_.pop_front();
+          products_.pop_front();
+        }
+        // modified Gram-Schmidt in the inner product of A, the products A v of the basis vectors are stored
+        std::vector<double> v = x;
+        double projected_energy = 0.0;
+        for(std::size_t k = 0; k < basis_.size(); ++k) {
+          double coefficient = dot(products_[k], v);
+          projected_energy += coefficient * coefficient;
+          for(std::size_t i = 0; i < v.size(); ++i) {
+            v[i] -= coefficient * basis_[k][i];
+          }
+        }
+        std::vector<double> product(v.size());
+        matrix.multiply(v.data(), product.data());
+        double energy = dot(v, product);
+        // the energy of x is split into the part in the span of the basis and the remainder v. If the
+        // remainder is at rounding level, x adds nothing to the basis
+        if(!(energy > 1e-20 * (energy + projected_energy))) {
+          return;
+        }
+        double scaling = 1.0 / std::sqrt(energy);
+        for(std::size_t i = 0; i < v.size(); ++i) {
+          v[i] *= scaling;
+          product[i] *= scaling;
+        }
+        basis_.push_back(std::move(v));
+        products_.push_back(std::move(product));
+      }
+    }
+
+    Strategy strategy() const
+    {
+      return strategy_;
+    }
+
+  private:
+    Strategy strategy_;
+    std::size_t basis_size_;
+    std::vector<double> previous_;
+    std::deque<std::vector<double>> basis_;
+    std::deque<std::vector<double>> products_;
+  };
+
+} // namespace duneuro_eeg_forward_test
+
+#endif // DUNEURO_EEG_FORWARD_TEST_WARM_START_HH
@@ -15,60 +15,45 @@
 #include <numeric>
 #include <algorithm>
 #include <iterator>
+#include <tuple>
 #include <dune/common/parametertreeparser.hh>
 #include <dune/common/fvector.hh>
+#include <dune/common/timer.hh>
 #include <duneuro/driver/driver_factory.hh>
 #include <duneuro/io/dipole_reader.hh>
 #include <duneuro/common/function.hh>
 #include <duneuro/io/point_vtk_writer.hh>
 #include <duneuro/io/field_vector_reader.hh>
 #include <duneuro/io/projections_reader.hh>
+#include <duneuro/io/data_tree.hh>
 #include <duneuro/common/dense_matrix.hh>
+#include <dune/duneuro_eeg_forward_test/analytic_solution_cache.hh>
+#include <dune/duneuro_eeg_forward_test/async_writer.hh>
+#include <dune/duneuro_eeg_forward_test/dipole_errors.hh>
+#include <dune/duneuro_eeg_forward_test/dipole_generator.hh>
+#include <dune/duneuro_eeg_forward_test/distribution.hh>
+#include <dune/duneuro_eeg_forward_test/electrode_generator.hh>
+#include <dune/duneuro_eeg_forward_test/electrode_projection_cache.hh>
+#include <dune/duneuro_eeg_forward_test/hash.hh>
+#include <dune/duneuro_eeg_forward_test/hdf5_series_writer.hh>
+#include <dune/duneuro_eeg_forward_test/mesh_cache.hh>
+#include <dune/duneuro_eeg_forward_test/mesh_refinement.hh>
+#include <dune/duneuro_eeg_forward_test/p1_forward_solver.hh>
+#include <dune/duneuro_eeg_forward_test/parallel_gmsh_reader.hh>
+#include <dune/duneuro_eeg_forward_test/parallel_for.hh>
+#include <dune/duneuro_eeg_forward_test/sphere_mesh_generator.hh>
+#include <dune/duneuro_eeg_forward_test/sphere_series_solution.hh>
+#include <dune/duneuro_eeg_forward_test/stage_profiler.hh>
+#include <dune/duneuro_eeg_forward_test/sweep_report.hh>
+#include <dune/duneuro_eeg_forward_test/vtu_writer.hh>
+#include <dune/duneuro_eeg_forward_test/warm_start.hh>
 #include <simbiosphere/analytic_solution.hh>              // simbiosphere implements the analytic solution of the EEG forward problem in sphere models
 
 
-// functions computing norm, relative error, MAG and RDM. Basically copied from 
+// norm, relative error, MAG and RDM are computed in a single pass by duneuro_eeg_forward_test::compute_dipole_errors.
+// The definitions follow
 // https://gitlab.dune-project.org/duneuro/duneuro-tests/-/blob/feature/2.8-changes/src/test_eeg_forward.cc
 
-// compute euclidean norm of a vector
-template<class T>
-T norm(const std::vector<T>& vector) {
-  return std::sqrt(std::inner_product(vector.begin(), vector.end(), vector.begin(), T(0.0)));
-}
-
-// compute relative error
-template<class T>
-  T relative_error(const std::vector<T>& numerical_solution, const std::vector<T>& analytical_solution) {
-  std::vector<T> diff;
-  std::transform(numerical_solution.begin(), 
-                 numerical_solution.end(), 
-                 analytical_solution.begin(), 
-                 std::back_inserter(diff),
-                 [] (const T& num_val, const T& ana_val) {return num_val - ana_val;});
-   return norm(diff) / norm(analytical_solution);
-}
-
-// compute MAG error
-template<class T>
-T magnitude_error(const std::vector<T>& numerical_solution, const std::vector<T>& analytical_solution) {
-  return norm(numerical_solution) / norm(analytical_solution);
-}
-
-// compute RDM error
-template<class T>
-T relative_difference_measure(const std::vector<T>& numerical_solution, const std::vector<T>& analytical_solution) {
-  T norm_numerical = norm(numerical_solution);
-  T norm_analytical = norm(analytical_solution);
-  std::vector<T> diff;
-  std::transform(numerical_solution.begin(),
-                 numerical_solution.end(),
-                 analytical_solution.begin(),
-                 std::back_inserter(diff),
-                 [norm_numerical, norm_analytical] (const T& num_val, const T& ana_val)
-                   {return num_val / norm_numerical - ana_val / norm_analytical;});
-  return norm(diff); 
-}
-
 // subtract mean of vector, so that new mean of vector is zero 
 template<class T>
 void subtract_mean(std::vector<T>& vector) {
@@ -97,6 +82,34 @@ void copy_to_vector_of_arrays(const std::vector<Dune::FieldVector<double, dim>>&
   }
 }
 
+// the fitted driver can be created from a mesh in memory instead of reading volume_conductor.grid.filename.
+// The conductivities are read from the tensor file and indexed by the element labels
+template<int dim>
+duneuro::MEEGDriverData<dim> make_driver_data(const duneuro_eeg_forward_test::TetrahedralMesh& mesh, const std::string& conductivities_filename) {
+  duneuro::MEEGDriverData<dim> data;
+  data.fittedData.nodes.reserve(mesh.nodes.size());
+  for(const auto& node : mesh.nodes) {
+    Dune::FieldVector<double, dim> position;
+    for(int i = 0; i < dim; ++i) {
+      position[i] = node[i];
+    }
+    data.fittedData.nodes.push_back(position);
+  }
+  data.fittedData.elements.reserve(mesh.elements.size());
+  for(const auto& element : mesh.elements) {
+    data.fittedData.elements.emplace_back(element.begin(), element.end());
+  }
+  data.fittedData.labels = mesh.labels;
+  for(const auto& conductivity : duneuro::FieldVectorReader<double, 1>::read(conductivities_filename)) {
+    data.fittedData.conductivities.push_back(conductivity[0]);
+  }
+  return data;
+}
+
+// the driver records the statistics of the linear solver of solveEEGForward in the data tree it is handed, the number
+// of iterations is stored under this key. Drivers not reporting it yield 0 iterations
+const std::string driver_iterations_key = "solver.iterations";
+
 
 
 
@@ -114,47 +127,275 @@ int main(int argc, char** argv)
     constexpr int dim = 3;
     
     
+    // wall clock time per stage of the program. The peak memory is recorded for the setup stages, the stages
+    // entered per dipole only measure time
+    duneuro_eeg_forward_test::StageProfiler profiler;
+    constexpr bool record_memory = duneuro_eeg_forward_test::StageProfiler::record_memory;
+    
+    
     // read parameter tree
     std::cout << " Reading parameter tree\n";
     Dune::ParameterTree config_tree;
     Dune::ParameterTreeParser config_parser;
-     
-    config_parser.readINITree("configs.ini", config_tree);
+    {
+      auto stage = profiler.scope("read_parameter_tree", record_memory);
+      config_parser.readINITree("configs.ini", config_tree);
+    }
     bool write_output = config_tree.get<bool>("output.write");
     std::cout << " Parameter tree read\n";
     
+    // in distributed mode every rank loads the mesh and handles a block of the dipoles. The results are
+    // gathered on rank 0, which is the only rank reporting to the console
+    bool distributed_mode = config_tree.get<bool>("batch.distributed", false) && helper.size() > 1;
+    if(distributed_mode && helper.rank() != 0) {
+      std::cout.rdbuf(nullptr);
+    }
+    
     
     // create driver
-    std::cout << " Creating driver\n";
     using Driver = duneuro::DriverInterface<dim>;
-    std::unique_ptr<Driver> driver_ptr = duneuro::DriverFactory<dim>::make_driver(config_tree);
-    std::cout << " Driver created\n";
+    std::unique_ptr<Driver> driver_ptr;
+    // the p1_cg backend solves the forward problem on the mesh loaded here instead of using the driver
+    std::string solver_backend = config_tree.get<std::string>("solver.backend", "driver");
+    if(solver_backend != "driver" && solver_backend != "p1_cg") {
+      DUNE_THROW(Dune::Exception, "unknown solver.backend " << solver_backend);
+    }
+    std::unique_ptr<duneuro_eeg_forward_test::P1ForwardSolver> p1_solver_ptr;
+    // the P1 discretization with partial integration dipoles has no notion of the source models of the driver, hence
+    // a sweep over them would report the same results for every source model
+    if(solver_backend == "p1_cg" && config_tree.get<bool>("source_model_sweep.enable", false)) {
+      DUNE_THROW(Dune::NotImplemented, "source_model_sweep requires solver.backend=driver, the p1_cg backend ignores source_model.type");
+    }
+    // blocks of dipoles are solved by the block CG of the p1_cg backend, the driver solves one dipole at a time
+    if(solver_backend == "driver" && config_tree.get<std::size_t>("solver.block_size", 1) > 1) {
+      DUNE_THROW(Dune::NotImplemented, "solver.block_size > 1 requires solver.backend=p1_cg");
+    }
+    // the driver chooses the precision of its linear solver itself
+    if(solver_backend == "driver" && config_tree.get<std::string>("solver.precision", "double") != "double") {
+      DUNE_THROW(Dune::NotImplemented, "solver.precision=" << config_tree.get<std::string>("solver.precision") << " requires solver.backend=p1_cg");
+    }
     
+    // in transfer mode the EEG transfer matrix is computed once and applied to every dipole, 
+    // otherwise the forward problem is solved for every dipole
+    bool transfer_mode = config_tree.get<bool>("transfer.enable", false);
     
-    // read dipole
-    std::cout << " Reading dipoles\n";
-    std::vector<duneuro::Dipole<ScalarType, dim>> dipoles = duneuro::DipoleReader<ScalarType, dim>::read(config_tree.get<std::string>("dipole.filename"));
-    std::cout << " Dipoles read\n";
-    duneuro::Dipole<ScalarType, dim> my_dipole = dipoles[0];
+    // volume output of the p1_cg backend, either one .vtu file per dipole or one HDF5 file with an XDMF descriptor per run
+    std::string volume_format = config_tree.get<std::string>("output.volume_format", "vtu");
+    if(volume_format != "vtu" && volume_format != "hdf5") {
+      DUNE_THROW(Dune::Exception, "unknown output.volume_format " << volume_format);
+    }
+    // the driver writes its volume output with the VTK writer of duneuro, which has no access to the HDF5 series
+    if(solver_backend == "driver" && volume_format == "hdf5") {
+      DUNE_THROW(Dune::NotImplemented, "output.volume_format=hdf5 requires solver.backend=p1_cg");
+    }
+    
+    // with output.asynchronous=true the output files are written on a background thread while the next dipoles
+    // are processed. Its tasks use the mesh of the P1 solver and the grid of the driver, hence it is declared after both
+    // and destroyed before them
+    duneuro_eeg_forward_test::AsyncWriter output_writer(write_output && config_tree.get<bool>("output.asynchronous", false),
+                                                        config_tree.get<std::size_t>("output.max_pending", 4));
     
-    // get EEG forward solution
-    std::cout << " Solve EEG forward problem numerically\n";
-    std::unique_ptr<duneuro::Function> solution_storage_ptr = driver_ptr->makeDomainFunction();
-    driver_ptr->solveEEGForward(my_dipole, *solution_storage_ptr, config_tree);
+    std::string mesh_parser = config_tree.get<std::string>("mesh.parser", "driver");
+    std::size_t parser_threads = config_tree.get<std::size_t>("mesh.threads", 0);
+    auto parse = [mesh_parser, parser_threads] (const std::string& filename) {
+      if(mesh_parser == "parallel") {
+        return duneuro_eeg_forward_test::read_gmsh_parallel(filename, parser_threads);
+      }
+      return duneuro_eeg_forward_test::read_gmsh(filename);
+    };
     
-    // evaluate potential at electrode positions
+    // identifies the mesh of the p1_cg backend for the electrode projection cache without hashing its content,
+    // 0 if no cheaper identification is known
+    std::uint64_t mesh_hash = 0;
+    
+    // create the driver, and the P1 solver of the p1_cg backend, from a mesh in memory
+    auto setup_from_mesh = [&] (duneuro_eeg_forward_test::TetrahedralMesh mesh, std::uint64_t hash = 0) {
+      // pending volume output refers to the mesh of the P1 solver to be replaced
+      output_writer.wait();
+      mesh_hash = hash;
+      duneuro::MEEGDriverData<dim> driver_data = make_driver_data<dim>(mesh, config_tree.get<std::string>("volume_conductor.tensors.filename"));
+      if(solver_backend == "p1_cg") {
+        auto assembly_stage = profiler.scope("assemble_matrix", record_memory);
+        p1_solver_ptr = std::make_unique<duneuro_eeg_forward_test::P1ForwardSolver>(std::move(mesh), driver_data.fittedData.conductivities);
+        std::string precision = config_tree.get<std::string>("solver.precision", "double");
+        if(precision == "mixed") {
+          p1_solver_ptr->enable_mixed_precision(config_tree.get<double>("solver.inner_reduction", 1e-5));
+        }
+        else if(precision != "double") {
+          DUNE_THROW(Dune::Exception, "unknown solver.precision " << precision);
+        }
+      }
+      driver_ptr = duneuro::DriverFactory<dim>::make_driver(config_tree, driver_data);
+    };
+    
+    // the mesh of the sphere model can be generated here instead of being read from volume_conductor.grid.filename
+    bool generate_mesh = config_tree.get<bool>("sphere_mesh.enable", false);
+    auto make_sphere_mesh = [&] () {
+      auto stage = profiler.scope("generate_mesh", record_memory);
+      duneuro_eeg_forward_test::TetrahedralMesh mesh 
+        = duneuro_eeg_forward_test::generate_sphere_mesh(config_tree.get<std::vector<double>>("analytic_solution.radii"),
+                                                         config_tree.get<std::array<double, dim>>("analytic_solution.center"),
+                                                         config_tree.get<double>("sphere_mesh.resolution"),
+                                                         config_tree.get<double>("sphere_mesh.node_shift", 0.3));
+      std::cout << " Generated a sphere mesh with " << mesh.nodes.size() << " vertices and " << mesh.elements.size() << " elements\n";
+      return mesh;
+    };
+    // the generated mesh is determined by its parameters
+    auto sphere_mesh_hash = [&] () {
+      duneuro_eeg_forward_test::Hash hash;
+      for(const char* key : {"analytic_solution.radii", "analytic_solution.center", "sphere_mesh.resolution"}) {
+        hash.add(config_tree.get<std::string>(key));
+      }
+      return hash.add(config_tree.get<std::string>("sphere_mesh.node_shift", "0.3")).value();
+    };
+    
+    // the studies run the dipoles several times and exclude each other. The convergence study creates a driver per
+    // mesh level, the driver of volume_conductor.grid.filename is not needed
+    bool source_model_sweep_mode = config_tree.get<bool>("source_model_sweep.enable", false);
+    bool tolerance_sweep_mode = config_tree.get<bool>("tolerance_sweep.enable", false);
+    bool convergence_mode = config_tree.get<bool>("convergence.enable", false);
+    if(source_model_sweep_mode + tolerance_sweep_mode + convergence_mode > 1) {
+      DUNE_THROW(Dune::Exception, "at most one of source_model_sweep, tolerance_sweep and convergence can be enabled");
+    }
+    if(!convergence_mode) {
+      std::cout << " Creating driver\n";
+      auto stage = profiler.scope("create_driver", record_memory);
+      // the mesh is either read by the driver itself, loaded here or generated here and handed to the driver in memory
+      bool mesh_cache = config_tree.get<bool>("mesh.cache", false);
+      if(generate_mesh) {
+        setup_from_mesh(make_sphere_mesh(), sphere_mesh_hash());
+      }
+      else if(mesh_cache || mesh_parser != "driver" || solver_backend == "p1_cg") {
+        std::string mesh_filename = config_tree.get<std::string>("volume_conductor.grid.filename");
+        duneuro_eeg_forward_test::TetrahedralMesh mesh;
+        std::uint64_t file_hash = 0;
+        {
+          auto load_stage = profiler.scope("load_mesh", record_memory);
+          if(mesh_cache) {
+            // parse the mesh only if the binary cache is missing or outdated
+            std::string cache_filename = config_tree.get<std::string>("mesh.cache_filename", mesh_filename + ".cache");
+            bool cache_hit;
+            mesh = duneuro_eeg_forward_test::load_mesh_with_cache(mesh_filename, cache_filename, parse, cache_hit, file_hash);
+            std::cout << (cache_hit ? " Mesh loaded from " : " Mesh parsed and cached in ") << cache_filename << "\n";
+          }
+          else {
+            mesh = parse(mesh_filename);
+          }
+        }
+        setup_from_mesh(std::move(mesh), file_hash);
+      }
+      else {
+        driver_ptr = duneuro::DriverFactory<dim>::make_driver(config_tree);
+      }
+      std::cout << " Driver created\n";
+    }
+    
+    
+    // read electrodes and project them onto the mesh
+    std::cout << " Reading electrodes\n";
     Dune::ParameterTree electrode_config = config_tree.sub("electrodes");
-    std::vector<Dune::FieldVector<ScalarType, dim>> my_electrodes = duneuro::FieldVectorReader<ScalarType, dim>::read(electrode_config.get<std::string>("filename"));
+    std::vector<Dune::FieldVector<ScalarType, dim>> my_electrodes;
+    std::string electrode_generator = electrode_config.get<std::string>("generator", "file");
+    if(electrode_generator == "fibonacci") {
+      // electrodes.count electrodes on the outer sphere of the analytical solution, unless radius or center are given
+      std::vector<ScalarType> radii = config_tree.get<std::vector<ScalarType>>("analytic_solution.radii");
+      std::array<ScalarType, dim> electrode_center = electrode_config.get<std::array<ScalarType, dim>>("center", config_tree.get<std::array<ScalarType, dim>>("analytic_solution.center"));
+      ScalarType electrode_radius = electrode_config.get<ScalarType>("radius", radii.front());
+      for(const auto& electrode : duneuro_eeg_forward_test::generate_fibonacci_electrodes(electrode_config.get<std::size_t>("count"), electrode_center, electrode_radius)) {
+        my_electrodes.emplace_back();
+        for(int i = 0; i < dim; ++i) {
+          my_electrodes.back()[i] = electrode[i];
+        }
+      }
+      std::cout << " Generated " << my_electrodes.size() << " electrodes\n";
+    }
+    else if(electrode_generator == "file") {
+      my_electrodes = duneuro::FieldVectorReader<ScalarType, dim>::read(electrode_config.get<std::string>("filename"));
+    }
+    else {
+      DUNE_THROW(Dune::Exception, "unknown electrodes.generator " << electrode_generator);
+    }
+    bool projection_cache = electrode_config.get<bool>("projection_cache", false);
+    std::string projection_cache_filename = electrode_config.get<std::string>("projection_cache_filename", "electrode_projection.cache");
+    auto set_electrodes = [&] () {
+      auto stage = profiler.scope("electrode_projection", record_memory);
+      // the p1_cg backend only uses the projection of the driver for the transfer matrix
+      if(!p1_solver_ptr || transfer_mode) {
+        driver_ptr->setElectrodes(my_electrodes, electrode_config);
+      }
+      if(p1_solver_ptr) {
+        std::vector<std::array<ScalarType, dim>> electrode_positions;
+        copy_to_vector_of_arrays(my_electrodes, electrode_positions);
+        if(projection_cache) {
+          // the projection is reused from an earlier run on the same mesh with the same electrodes
+          bool cache_hit;
+          auto project = [&] (const std::vector<std::array<ScalarType, dim>>& electrodes) {
+            return p1_solver_ptr->project_electrodes(electrodes);
+          };
+          std::uint64_t projection_mesh_hash = mesh_hash != 0 ? mesh_hash : duneuro_eeg_forward_test::hash_mesh(p1_solver_ptr->mesh());
+          p1_solver_ptr->set_electrode_vertices(duneuro_eeg_forward_test::load_electrode_projection_with_cache(projection_cache_filename, projection_mesh_hash, electrode_positions, project, cache_hit));
+          std::cout << (cache_hit ? " Electrode projection loaded from " : " Electrode projection computed and cached in ") << projection_cache_filename << "\n";
+        }
+        else {
+          p1_solver_ptr->set_electrodes(electrode_positions);
+        }
+      }
+    };
+    std::cout << " Electrodes read\n";
+    
     
-    driver_ptr->setElectrodes(my_electrodes, electrode_config);
-    std::vector<ScalarType> solution_at_electrode_projections = driver_ptr->evaluateAtElectrodes(*solution_storage_ptr);
-    subtract_mean(solution_at_electrode_projections);
-    std::cout << " Numerical solution computed\n";
+    // read dipole
+    std::cout << " Reading dipoles\n";
+    std::vector<duneuro::Dipole<ScalarType, dim>> dipoles;
+    std::string dipole_generator = config_tree.get<std::string>("dipole.generator", "file");
+    if(dipole_generator == "grid") {
+      // dipoles at given eccentricities relative to the innermost sphere of the analytical solution
+      Dune::ParameterTree dipole_config = config_tree.sub("dipole");
+      std::vector<ScalarType> radii = config_tree.get<std::vector<ScalarType>>("analytic_solution.radii");
+      auto generated_dipoles = duneuro_eeg_forward_test::generate_dipole_grid(config_tree.get<std::array<ScalarType, dim>>("analytic_solution.center"),
+                                                                             radii.back(),
+                                                                             dipole_config.get<std::size_t>("directions"),
+                                                                             dipole_config.get<ScalarType>("eccentricity_min"),
+                                                                             dipole_config.get<ScalarType>("eccentricity_max"),
+                                                                             dipole_config.get<std::size_t>("eccentricity_steps"),
+                                                                             dipole_config.get<std::string>("orientation"));
+      dipoles.reserve(generated_dipoles.size());
+      for(const auto& generated_dipole : generated_dipoles) {
+        Dune::FieldVector<ScalarType, dim> position;
+        Dune::FieldVector<ScalarType, dim> moment;
+        for(int i = 0; i < dim; ++i) {
+          position[i] = generated_dipole.position[i];
+          moment[i] = generated_dipole.moment[i];
+        }
+        dipoles.emplace_back(position, moment);
+      }
+      std::cout << " Generated " << dipoles.size() << " dipoles\n";
+    }
+    else if(dipole_generator == "file") {
+      dipoles = duneuro::DipoleReader<ScalarType, dim>::read(config_tree.get<std::string>("dipole.filename"));
+    }
+    else {
+      DUNE_THROW(Dune::Exception, "unknown dipole.generator " << dipole_generator);
+    }
+    std::cout << " Dipoles read\n";
     
+    // in batch mode every dipole is solved using the same driver, otherwise only the first one
+    bool batch_mode = config_tree.get<bool>("batch.enable", false);
+    std::size_t number_of_dipoles = batch_mode ? dipoles.size() : 1;
+    if(batch_mode) {
+      std::cout << " Batch mode, solving " << number_of_dipoles << " dipoles\n";
+    }
+    
+    std::size_t first_dipole = 0;
+    std::size_t last_dipole = number_of_dipoles;
+    if(distributed_mode) {
+      std::tie(first_dipole, last_dipole) = duneuro_eeg_forward_test::block_range(number_of_dipoles, helper.rank(), helper.size());
+      std::cout << " Distributing the dipoles over " << helper.size() << " ranks\n";
+    }
+    std::size_t number_of_local_dipoles = last_dipole - first_dipole;
     
     
-    // compute analytical solution
-    std::cout << " Computing analytical solution using simbiosphere\n";
+    // parameters of the analytical solution
     constexpr int number_of_layers = 4;
     std::array<ScalarType, number_of_layers> radii = config_tree.get<std::array<ScalarType, number_of_layers>>("analytic_solution.radii");
     std::array<ScalarType, dim> center = config_tree.get<std::array<double, dim>>("analytic_solution.center");
@@ -163,59 +404,630 @@ int main(int argc, char** argv)
     std::array<ScalarType, number_of_layers> conductivities_simbio;
     copy_to_array(conductivities[0], conductivities_simbio);
     
-
-    // store electrodes and dipole in the data structure simbiosphere expects
+    // store electrodes in the data structure simbiosphere expects
     std::vector<std::array<ScalarType, dim>> electrodes_simbio;
     copy_to_vector_of_arrays(my_electrodes, electrodes_simbio);
-
-    std::array<ScalarType, dim> dipole_position_simbio;
-    copy_to_array(my_dipole.position(), dipole_position_simbio);
-    std::array<ScalarType, dim> dipole_moment_simbio;
-    copy_to_array(my_dipole.moment(), dipole_moment_simbio);
     
-
-    std::vector<ScalarType> analytical_solution = simbiosphere::analytic_solution(radii, 
-                                                                                  center, 
-                                                                                  conductivities_simbio, 
-                                                                                  electrodes_simbio, 
-                                                                                  dipole_position_simbio, 
-                                                                                  dipole_moment_simbio);
-    subtract_mean(analytical_solution);
-    std::cout << " Analytical solution computed\n";
-    
-    
-    // compare numerical and analytical solution
-    std::cout << "\n We now compare the analytical and the numerical solution\n";
-    
-    std::cout << " Norm of analytical solution : " << norm(analytical_solution) << "\n";
-    std::cout << " Norm of numerical solution : " << norm(solution_at_electrode_projections) << "\n";
-    std::cout << " Relative error : " << relative_error(solution_at_electrode_projections, analytical_solution) << "\n";
-    std::cout << " MAG : " << magnitude_error(solution_at_electrode_projections, analytical_solution) << "\n";
-    std::cout << " RDM : " << relative_difference_measure(solution_at_electrode_projections, analytical_solution) << "\n";
-    
-    std::cout << " Comparison finished\n\n";
-    
-    // visualization
-    if(write_output) {
-      std::cout << " We now write the solution in the vtk-format\n";
-      std::cout << " We first write the headmodel\n";
-      auto volume_writer_ptr = driver_ptr->volumeConductorVTKWriter(config_tree);
-      volume_writer_ptr->addVertexData(*solution_storage_ptr, "potential");
-      volume_writer_ptr->addCellDataGradient(*solution_storage_ptr, "gradient");
-      volume_writer_ptr->write(config_tree.sub("output"));
-       	
-      std::cout << " We now write the dipole\n";
-      duneuro::PointVTKWriter<ScalarType, dim> dipole_writer{my_dipole};
-      std::string dipole_filename_string = config_tree.get<std::string>("output.filename_dipole");
-      dipole_writer.write(dipole_filename_string);
+    // simbiosphere evaluates the series electrode by electrode, the series method evaluates it for blocks of electrodes using SIMD
+    std::string analytic_method = config_tree.get<std::string>("analytic_solution.method", "simbiosphere");
+    std::unique_ptr<duneuro_eeg_forward_test::SphereSeriesSolution<number_of_layers>> series_solution_ptr;
+    if(analytic_method == "series") {
+      series_solution_ptr = std::make_unique<duneuro_eeg_forward_test::SphereSeriesSolution<number_of_layers>>(radii, center, conductivities_simbio, electrodes_simbio);
+    }
+    else if(analytic_method != "simbiosphere") {
+      DUNE_THROW(Dune::Exception, "unknown analytic_solution.method " << analytic_method);
+    }
+    
+    // the analytical potentials can be reused from earlier runs with the same radii, center, conductivities and electrodes
+    std::unique_ptr<duneuro_eeg_forward_test::AnalyticSolutionCache> analytic_cache_ptr;
+    if(config_tree.get<bool>("analytic_solution.cache", false)) {
+      std::uint64_t setup_hash = duneuro_eeg_forward_test::analytic_setup_hash(analytic_method, radii, center, conductivities_simbio, electrodes_simbio);
+      std::string cache_filename = config_tree.get<std::string>("analytic_solution.cache_filename", "analytic_solution.cache");
+      analytic_cache_ptr = std::make_unique<duneuro_eeg_forward_test::AnalyticSolutionCache>(cache_filename, setup_hash, electrodes_simbio.size());
+    }
+    
+    
+    std::unique_ptr<duneuro::DenseMatrix<ScalarType>> transfer_matrix_ptr;
+    // computes the transfer matrix of the current driver and electrodes using the solver settings of transfer_config,
+    // returns the time taken
+    auto compute_transfer_matrix = [&] (const Dune::ParameterTree& transfer_config) {
+      std::cout << " Computing EEG transfer matrix\n";
+      Dune::Timer transfer_timer;
+      {
+        auto stage = profiler.scope("transfer_matrix", record_memory);
+        transfer_matrix_ptr = driver_ptr->computeEEGTransferMatrix(transfer_config);
+      }
+      double transfer_time = transfer_timer.elapsed();
+      std::cout << " EEG transfer matrix computed in " << transfer_time << " s\n";
+      return transfer_time;
+    };
+    // projects the electrodes onto the mesh of the current driver and, in transfer mode, computes the transfer matrix
+    // unless with_transfer_matrix is false. Returns the time of the transfer matrix
+    auto prepare_driver = [&] (bool with_transfer_matrix) {
+      set_electrodes();
+      return transfer_mode && with_transfer_matrix ? compute_transfer_matrix(config_tree) : 0.0;
+    };
+    // the convergence study prepares the driver of every mesh level, the tolerance sweep computes a transfer matrix
+    // per solver reduction
+    if(!convergence_mode) {
+      prepare_driver(!tolerance_sweep_mode);
+    }
+    
+    // analytical solution at the electrodes for the given dipole
+    auto compute_analytical_solution = [&] (const duneuro::Dipole<ScalarType, dim>& dipole) {
+      auto stage = profiler.scope("analytic_solution");
+      std::array<ScalarType, dim> dipole_position_simbio;
+      copy_to_array(dipole.position(), dipole_position_simbio);
+      std::array<ScalarType, dim> dipole_moment_simbio;
+      copy_to_array(dipole.moment(), dipole_moment_simbio);
+      
+      std::vector<ScalarType> analytical_solution;
+      std::uint64_t dipole_hash = duneuro_eeg_forward_test::analytic_dipole_hash(dipole_position_simbio, dipole_moment_simbio);
+      if(!analytic_cache_ptr || !analytic_cache_ptr->find(dipole_hash, analytical_solution)) {
+        if(series_solution_ptr) {
+          analytical_solution = series_solution_ptr->evaluate(dipole_position_simbio, dipole_moment_simbio);
+        }
+        else {
+          analytical_solution = simbiosphere::analytic_solution(radii, 
+                                                                center, 
+                                                                conductivities_simbio, 
+                                                                electrodes_simbio, 
+                                                                dipole_position_simbio, 
+                                                                dipole_moment_simbio);
+        }
+        if(analytic_cache_ptr) {
+          analytic_cache_ptr->insert(dipole_hash, analytical_solution);
+        }
+      }
+      subtract_mean(analytical_solution);
+      return analytical_solution;
+    };
+    
+    // error measures of the numerical with respect to the analytical solution
+    auto compare_solutions = [&profiler] (const std::vector<ScalarType>& numerical_solution, const std::vector<ScalarType>& analytical_solution) {
+      auto stage = profiler.scope("metrics");
+      return duneuro_eeg_forward_test::compute_dipole_errors(numerical_solution, analytical_solution);
+    };
+    
+    // write dipole and electrode potentials. In batch mode the output files are suffixed by the dipole index,
+    // output_suffix distinguishes the runs of a sweep
+    auto write_point_output = [&] (std::size_t dipole_index,
+                                   const duneuro::Dipole<ScalarType, dim>& dipole,
+                                   const std::vector<ScalarType>& numerical_solution,
+                                   const std::vector<ScalarType>& analytical_solution,
+                                   const std::string& output_suffix) {
+      std::string suffix = output_suffix + (batch_mode ? "_" + std::to_string(dipole_index) : "");
       
-      duneuro::PointVTKWriter<ScalarType, dim> potential_writer{my_electrodes};
+      // the writers copy the points and data, so they are the snapshot handed to output_writer
+      auto dipole_writer = std::make_shared<duneuro::PointVTKWriter<ScalarType, dim>>(dipole);
+      std::string dipole_filename_string = config_tree.get<std::string>("output.filename_dipole") + suffix;
       
-      std::cout << " We now write the potential at the electrodes computed analytically and numerically\n";
-      potential_writer.addScalarData("potential_analytical", analytical_solution);
-      potential_writer.addScalarData("potential_numerical", solution_at_electrode_projections);
-      std::string electrode_potential_filename_string =config_tree.get<std::string>("output.filename_electrode_potentials");
-      potential_writer.write(electrode_potential_filename_string);
+      auto potential_writer = std::make_shared<duneuro::PointVTKWriter<ScalarType, dim>>(my_electrodes);
+      potential_writer->addScalarData("potential_analytical", analytical_solution);
+      potential_writer->addScalarData("potential_numerical", numerical_solution);
+      std::string electrode_potential_filename_string = config_tree.get<std::string>("output.filename_electrode_potentials") + suffix;
+      
+      output_writer.submit([&profiler, dipole_writer, dipole_filename_string, potential_writer, electrode_potential_filename_string] () {
+        auto stage = profiler.scope("output");
+        dipole_writer->write(dipole_filename_string);
+        potential_writer->write(electrode_potential_filename_string);
+      });
+    };
+    
+    // once the transfer matrix exists, the dipoles are independent of each other. The driver applies the matrix
+    // using several threads, the evaluation of the dipoles is distributed over the same number of threads.
+    // Solving the forward problem uses the solver state of the driver and is thus done serially
+    std::size_t number_of_threads = duneuro_eeg_forward_test::resolve_number_of_threads(config_tree.get<std::size_t>("batch.threads", 1));
+    bool threaded_sweep = transfer_mode && number_of_threads > 1;
+    
+    // errors of all dipoles and the effort of the numerical solution of this rank for one run over the dipoles.
+    // Iterations are counted by both backends when solving per dipole, the transfer matrix is applied without iterating
+    struct RunResult {
+      std::vector<duneuro_eeg_forward_test::DipoleErrors> errors;
+      std::size_t iterations = 0;
+      double solve_time = 0.0;
+    };
+    
+    // solve the dipoles of this rank using run_config and compare them to the analytical solution. The errors are
+    // stored at the index of the dipole, entries of dipoles handled by other ranks are left untouched
+    auto run_dipoles = [&] (const Dune::ParameterTree& run_config, const std::string& output_suffix) {
+      RunResult run;
+      std::vector<duneuro_eeg_forward_test::DipoleErrors>& dipole_errors = run.errors;
+      dipole_errors.resize(number_of_dipoles);
+      double transfer_apply_time = 0.0;
+      
+      if(threaded_sweep) {
+        std::cout << " Sweeping over " << number_of_local_dipoles << " dipoles using " << number_of_threads << " threads\n";
+        
+        // the transfer matrix is applied by a single call, which the driver parallelizes itself. The driver is not
+        // used concurrently, only the comparison to the analytical solution and the output are split over the threads
+        Dune::ParameterTree apply_config = run_config;
+        apply_config["numberOfThreads"] = std::to_string(number_of_threads);
+        std::size_t chunk_size = config_tree.get<std::size_t>("batch.chunk_size", 16);
+        
+        Dune::Timer sweep_timer;
+        std::vector<duneuro::Dipole<ScalarType, dim>> local_dipoles(dipoles.begin() + first_dipole, dipoles.begin() + first_dipole + number_of_local_dipoles);
+        std::vector<std::vector<ScalarType>> numerical_solutions;
+        {
+          auto stage = profiler.scope("transfer_apply");
+          numerical_solutions = driver_ptr->applyEEGTransfer(*transfer_matrix_ptr, local_dipoles, apply_config);
+        }
+        
+        duneuro_eeg_forward_test::parallel_for(number_of_local_dipoles, number_of_threads, chunk_size, [&] (std::size_t begin, std::size_t end) {
+          for(std::size_t local_index = begin; local_index < end; ++local_index) {
+            std::size_t dipole_index = first_dipole + local_index;
+            std::vector<ScalarType>& numerical_solution = numerical_solutions[local_index];
+            subtract_mean(numerical_solution);
+            std::vector<ScalarType> analytical_solution = compute_analytical_solution(dipoles[dipole_index]);
+            dipole_errors[dipole_index] = compare_solutions(numerical_solution, analytical_solution);
+            if(write_output) {
+              write_point_output(dipole_index, dipoles[dipole_index], numerical_solution, analytical_solution, output_suffix);
+            }
+          }
+        });
+        double sweep_time = sweep_timer.elapsed();
+        run.solve_time = sweep_time;
+        std::cout << " Sweep finished in " << sweep_time << " s, i.e. " << sweep_time / number_of_local_dipoles << " s per dipole\n";
+      }
+      else {
+        // the function of the driver the current dipole is solved into. Pending volume output shares it until written
+        std::shared_ptr<duneuro::Function> solution_storage_ptr = driver_ptr->makeDomainFunction();
+        bool volume_output_pending = false;
+        
+        // state of the p1_cg backend, the previous solutions of this run provide the initial guesses
+        std::vector<ScalarType> p1_solution;
+        duneuro_eeg_forward_test::WarmStart warm_start(duneuro_eeg_forward_test::WarmStart::strategy_from_string(run_config.get<std::string>("solver.warm_start", "none")),
+                                                       run_config.get<std::size_t>("solver.warm_start_basis", 4));
+        // the linear solver of the driver starts from the function it is handed. Keeping the storage of the previous
+        // dipole thus warm starts it, a fresh storage starts from zero. The driver function is opaque, hence
+        // combinations of earlier solutions are not available
+        if(!p1_solver_ptr && !transfer_mode && warm_start.strategy() == duneuro_eeg_forward_test::WarmStart::Strategy::projection) {
+          DUNE_THROW(Dune::NotImplemented, "solver.warm_start=projection requires solver.backend=p1_cg");
+        }
+        bool driver_warm_start = warm_start.strategy() == duneuro_eeg_forward_test::WarmStart::Strategy::previous;
+        // with solver.block_size > 1 the dipoles are solved in blocks by block CG, the electrode potentials of the
+        // current block are kept until its dipoles are processed
+        std::size_t block_size = std::max<std::size_t>(run_config.get<std::size_t>("solver.block_size", 1), 1);
+        std::size_t block_begin = first_dipole;
+        std::vector<ScalarType> block_solutions;
+        
+        // with output.volume_format=hdf5 the volume solutions of the p1_cg backend of this run are collected in a
+        // single HDF5 file. The serial HDF5 library is not thread safe, hence it is only used by tasks of output_writer
+        std::shared_ptr<std::unique_ptr<duneuro_eeg_forward_test::Hdf5SeriesWriter>> series;
+        // buffer for the cell gradients of the volume output of the p1_cg backend, reused for all dipoles of this run.
+        // It is only accessed by the tasks of output_writer, which run one after another
+        auto gradient_buffer = std::make_shared<std::vector<ScalarType>>();
+        std::size_t output_threads = config_tree.get<std::size_t>("output.threads", 1);
+        if(write_output && p1_solver_ptr && !transfer_mode && volume_format == "hdf5") {
+          series = std::make_shared<std::unique_ptr<duneuro_eeg_forward_test::Hdf5SeriesWriter>>();
+          const duneuro_eeg_forward_test::TetrahedralMesh& mesh = p1_solver_ptr->mesh();
+          std::string series_filename = config_tree.get<std::string>("output.filename") + output_suffix
+                                      + (distributed_mode ? "_rank_" + std::to_string(helper.rank()) : "");
+          output_writer.submit([&mesh, &config_tree, series, series_filename] () {
+            *series = std::make_unique<duneuro_eeg_forward_test::Hdf5SeriesWriter>(mesh, series_filename,
+                                                                                   config_tree.get<int>("output.hdf5_compression_level", 0),
+                                                                                   config_tree.get<std::size_t>("output.hdf5_chunk_rows", 1 << 14));
+          });
+        }
+        
+        for(std::size_t dipole_index = first_dipole; dipole_index < last_dipole; ++dipole_index) {
+          const duneuro::Dipole<ScalarType, dim>& my_dipole = dipoles[dipole_index];
+          if(batch_mode) {
+            std::cout << "\n Dipole " << dipole_index << "\n";
+          }
+          
+          std::vector<ScalarType> solution_at_electrode_projections;
+          if(transfer_mode) {
+            // apply EEG transfer matrix
+            std::cout << " Apply EEG transfer matrix\n";
+            Dune::Timer apply_timer;
+            {
+              auto stage = profiler.scope("transfer_apply");
+              solution_at_electrode_projections = driver_ptr->applyEEGTransfer(*transfer_matrix_ptr, {my_dipole}, run_config)[0];
+            }
+            double apply_time = apply_timer.elapsed();
+            transfer_apply_time += apply_time;
+            run.solve_time += apply_time;
+            std::cout << " EEG transfer matrix applied in " << apply_time << " s\n";
+          }
+          else if(p1_solver_ptr && block_size > 1) {
+            if(dipole_index == first_dipole || dipole_index - block_begin == block_size) {
+              block_begin = dipole_index;
+              std::size_t block_end = std::min(block_begin + block_size, last_dipole);
+              std::cout << " Solve EEG forward problem for dipoles " << block_begin << " to " << block_end - 1 << " using block CG\n";
+              std::vector<std::array<ScalarType, dim>> positions(block_end - block_begin);
+              std::vector<std::array<ScalarType, dim>> moments(block_end - block_begin);
+              for(std::size_t i = block_begin; i < block_end; ++i) {
+                copy_to_array(dipoles[i].position(), positions[i - block_begin]);
+                copy_to_array(dipoles[i].moment(), moments[i - block_begin]);
+              }
+              Dune::Timer solve_timer;
+              duneuro_eeg_forward_test::SolverResult result;
+              {
+                auto stage = profiler.scope("forward_solve");
+                result = p1_solver_ptr->solve_block(positions, moments, block_solutions,
+                                                    run_config.get<double>("solver.reduction"), run_config.get<std::size_t>("solver.max_iterations", 10000));
+              }
+              run.solve_time += solve_timer.elapsed();
+              run.iterations += result.iterations;
+              std::cout << " Block CG iterations : " << result.iterations << ", reduction " << result.reduction << "\n";
+              if(!result.converged) {
+                std::cout << " Warning : block CG did not reach solver.reduction\n";
+              }
+            }
+            
+            auto stage = profiler.scope("evaluate_at_electrodes");
+            std::size_t current_block_size = std::min(block_begin + block_size, last_dipole) - block_begin;
+            solution_at_electrode_projections = p1_solver_ptr->evaluate_at_electrodes(block_solutions, current_block_size, dipole_index - block_begin);
+          }
+          else if(p1_solver_ptr) {
+            std::cout << " Solve EEG forward problem using the P1 CG solver\n";
+            std::array<ScalarType, dim> position;
+            copy_to_array(my_dipole.position(), position);
+            std::array<ScalarType, dim> moment;
+            copy_to_array(my_dipole.moment(), moment);
+            Dune::Timer solve_timer;
+            duneuro_eeg_forward_test::SolverResult result;
+            {
+              auto stage = profiler.scope("forward_solve");
+              result = p1_solver_ptr->solve(position, moment, p1_solution, warm_start,
+                                            run_config.get<double>("solver.reduction"), run_config.get<std::size_t>("solver.max_iterations", 10000));
+            }
+            run.solve_time += solve_timer.elapsed();
+            run.iterations += result.iterations;
+            std::cout << " CG iterations : " << result.iterations << ", reduction " << result.reduction;
+            if(result.refinements > 0) {
+              std::cout << ", refinement steps " << result.refinements;
+            }
+            std::cout << "\n";
+            if(!result.converged) {
+              std::cout << " Warning : CG did not reach solver.reduction\n";
+            }
+            
+            auto stage = profiler.scope("evaluate_at_electrodes");
+            solution_at_electrode_projections = p1_solver_ptr->evaluate_at_electrodes(p1_solution);
+          }
+          else {
+            // get EEG forward solution
+            std::cout << " Solve EEG forward problem numerically\n";
+            // the function of the previous dipole may still be read by its volume output. Without warm start the
+            // solve gets a fresh function, with warm start it has to wait until the output is written
+            if(!driver_warm_start && dipole_index != first_dipole) {
+              solution_storage_ptr = driver_ptr->makeDomainFunction();
+            }
+            else if(volume_output_pending) {
+              auto stage = profiler.scope("output_wait");
+              output_writer.wait();
+            }
+            volume_output_pending = false;
+            Dune::Timer solve_timer;
+            duneuro::DataTree solve_statistics;
+            {
+              auto stage = profiler.scope("forward_solve");
+              driver_ptr->solveEEGForward(my_dipole, *solution_storage_ptr, run_config, solve_statistics);
+            }
+            run.solve_time += solve_timer.elapsed();
+            std::size_t iterations = solve_statistics.get<std::size_t>(driver_iterations_key, 0);
+            run.iterations += iterations;
+            std::cout << " Solver iterations : " << iterations << "\n";
+            
+            // evaluate potential at electrode positions
+            auto stage = profiler.scope("evaluate_at_electrodes");
+            solution_at_electrode_projections = driver_ptr->evaluateAtElectrodes(*solution_storage_ptr);
+          }
+          subtract_mean(solution_at_electrode_projections);
+          std::cout << " Numerical solution computed\n";
+          
+          
+          // compute analytical solution
+          std::cout << " Computing analytical solution using simbiosphere\n";
+          std::vector<ScalarType> analytical_solution = compute_analytical_solution(my_dipole);
+          std::cout << " Analytical solution computed\n";
+          
+          
+          // compare numerical and analytical solution
+          std::cout << "\n We now compare the analytical and the numerical solution\n";
+          
+          duneuro_eeg_forward_test::DipoleErrors& errors = dipole_errors[dipole_index];
+          errors = compare_solutions(solution_at_electrode_projections, analytical_solution);
+          
+          std::cout << " Norm of analytical solution : " << errors.norm_analytical << "\n";
+          std::cout << " Norm of numerical solution : " << errors.norm_numerical << "\n";
+          std::cout << " Relative error : " << errors.relative_error << "\n";
+          std::cout << " MAG : " << errors.mag << "\n";
+          std::cout << " RDM : " << errors.rdm << "\n";
+          
+          std::cout << " Comparison finished\n\n";
+          
+          // visualization
+          if(write_output) {
+            std::cout << " We now write the solution in the vtk-format\n";
+            // the transfer matrix only yields the potential at the electrodes, hence there is no volume solution to write
+            if(!transfer_mode && !p1_solver_ptr) {
+              std::cout << " We first write the headmodel\n";
+              Dune::ParameterTree output_config = config_tree.sub("output");
+              output_config["filename"] = output_config.get<std::string>("filename") + output_suffix + (batch_mode ? "_" + std::to_string(dipole_index) : "");
+              // the writer is created and the data is attached here, since this uses the driver. The data is only
+              // evaluated by write, which reads the grid and the function of this dipole and is left to output_writer.
+              // The task shares the function, the next dipole is solved into a fresh one or waits for the task.
+              // duneuro evaluates the cell gradients serially, output.threads only applies to the p1_cg backend
+              std::shared_ptr<duneuro::VolumeConductorVTKWriterInterface> volume_writer_ptr;
+              {
+                auto stage = profiler.scope("output_prepare");
+                volume_writer_ptr = driver_ptr->volumeConductorVTKWriter(config_tree);
+                volume_writer_ptr->addVertexData(*solution_storage_ptr, "potential");
+                volume_writer_ptr->addCellDataGradient(*solution_storage_ptr, "gradient");
+              }
+              output_writer.submit([&profiler, volume_writer_ptr, solution_storage_ptr, output_config] () {
+                auto stage = profiler.scope("output");
+                volume_writer_ptr->write(output_config);
+              });
+              volume_output_pending = true;
+            }
+            else if(!transfer_mode) {
+              // the solution of the p1_cg backend is not a function of the driver, it is written by this module, either
+              // by the VTU writer as appended raw binary, optionally compressed by output.compression, or as a step of
+              // the HDF5 series of this run
+              std::vector<ScalarType> solution_snapshot;
+              if(block_size > 1) {
+                std::size_t current_block_size = std::min(block_begin + block_size, last_dipole) - block_begin;
+                solution_snapshot.resize(p1_solver_ptr->mesh().nodes.size());
+                for(std::size_t i = 0; i < solution_snapshot.size(); ++i) {
+                  solution_snapshot[i] = block_solutions[i * current_block_size + dipole_index - block_begin];
+                }
+              }
+              else {
+                solution_snapshot = p1_solution;
+              }
+              const duneuro_eeg_forward_test::TetrahedralMesh& mesh = p1_solver_ptr->mesh();
+              if(series) {
+                std::cout << " We first add the solution to the HDF5 series\n";
+                output_writer.submit([&profiler, &mesh, series, gradient_buffer, output_threads, dipole_index, solution_snapshot] () {
+                  auto stage = profiler.scope("output");
+                  duneuro_eeg_forward_test::compute_cell_gradients(mesh, solution_snapshot, *gradient_buffer, output_threads);
+                  (*series)->add_step(dipole_index, solution_snapshot, *gradient_buffer);
+                });
+              }
+              else {
+                std::cout << " We first write the headmodel\n";
+                std::string volume_filename = config_tree.get<std::string>("output.filename") + output_suffix + (batch_mode ? "_" + std::to_string(dipole_index) : "");
+                output_writer.submit([&profiler, &mesh, &config_tree, gradient_buffer, output_threads, volume_filename, solution_snapshot, dim] () {
+                  auto stage = profiler.scope("output");
+                  duneuro_eeg_forward_test::compute_cell_gradients(mesh, solution_snapshot, *gradient_buffer, output_threads);
+                  duneuro_eeg_forward_test::VtuWriter volume_writer(mesh);
+                  volume_writer.add_vertex_data("potential", solution_snapshot);
+                  volume_writer.add_cell_data("gradient", *gradient_buffer, dim);
+                  volume_writer.write(volume_filename,
+                                      duneuro_eeg_forward_test::compression_from_string(config_tree.get<std::string>("output.compression", "none")),
+                                      output_threads,
+                                      config_tree.get<std::size_t>("output.block_size", 1 << 15),
+                                      config_tree.get<int>("output.compression_level", 1));
+                });
+              }
+            }
+            
+            std::cout << " We now write the dipole and the potential at the electrodes computed analytically and numerically\n";
+            write_point_output(dipole_index, my_dipole, solution_at_electrode_projections, analytical_solution, output_suffix);
+          }
+        }
+        
+        if(series) {
+          // closing the file writes the XDMF descriptor
+          output_writer.submit([series] () {
+            series->reset();
+          });
+        }
+        
+        if(!transfer_mode) {
+          if(p1_solver_ptr && block_size > 1) {
+            std::cout << "\n Block CG iterations over " << number_of_local_dipoles << " dipoles in blocks of " << block_size << " : " << run.iterations << "\n";
+          }
+          else {
+            std::cout << "\n " << (p1_solver_ptr ? "CG" : "Solver") << " iterations over " << number_of_local_dipoles << " dipoles : " << run.iterations 
+                      << ", i.e. " << static_cast<double>(run.iterations) / number_of_local_dipoles << " per dipole using warm start "
+                      << run_config.get<std::string>("solver.warm_start", "none") << "\n";
+          }
+          std::cout << " Solving took " << run.solve_time << " s, i.e. " << number_of_local_dipoles / run.solve_time << " dipoles per second\n";
+        }
+      }
+      
+      if(transfer_mode && !threaded_sweep) {
+        std::cout << "\n Applying the EEG transfer matrix to " << number_of_local_dipoles << " dipoles took " << transfer_apply_time 
+                  << " s, i.e. " << transfer_apply_time / number_of_local_dipoles << " s per dipole\n";
+      }
+      
+      if(distributed_mode) {
+        duneuro_eeg_forward_test::gather_dipole_errors(helper.getCommunication(), dipole_errors);
+      }
+      return run;
+    };
+    
+    
+    if(source_model_sweep_mode) {
+      // run the same dipoles through every listed source model. Keys in a section source_model_sweep.<type>
+      // override the keys of the source_model section for this type
+      std::vector<std::string> source_model_types = config_tree.get<std::vector<std::string>>("source_model_sweep.types");
+      std::vector<duneuro_eeg_forward_test::SweepEntry> sweep_entries;
+      for(const std::string& source_model_type : source_model_types) {
+        std::cout << "\n Source model " << source_model_type << "\n";
+        Dune::ParameterTree run_config = config_tree;
+        run_config["source_model.type"] = source_model_type;
+        std::string override_section = "source_model_sweep." + source_model_type;
+        if(config_tree.hasSub(override_section)) {
+          const Dune::ParameterTree& overrides = config_tree.sub(override_section);
+          for(const std::string& key : overrides.getValueKeys()) {
+            run_config["source_model." + key] = overrides.get<std::string>(key);
+          }
+        }
+        
+        Dune::Timer source_model_timer;
+        duneuro_eeg_forward_test::SweepEntry entry;
+        entry.label = source_model_type;
+        entry.errors = run_dipoles(run_config, "_" + source_model_type).errors;
+        double time = source_model_timer.elapsed();
+        entry.values = {{"time", time}, {"time_per_dipole", time / number_of_local_dipoles}};
+        sweep_entries.push_back(std::move(entry));
+      }
+      
+      if(helper.rank() == 0) {
+        std::cout << "\n Source model comparison over " << number_of_dipoles << " dipoles\n";
+        duneuro_eeg_forward_test::print_sweep_report(std::cout, "source_model", sweep_entries);
+        if(config_tree.hasKey("source_model_sweep.filename")) {
+          duneuro_eeg_forward_test::write_sweep_csv(config_tree.get<std::string>("source_model_sweep.filename"), "source_model", sweep_entries);
+        }
+        std::cout << "\n";
+      }
+    }
+    else if(tolerance_sweep_mode) {
+      // solve the same dipoles once per solver reduction to weigh the accuracy against the cost of the solve. In
+      // transfer mode the reduction applies to the solves of the transfer matrix, which is recomputed per reduction
+      std::vector<std::string> reductions = config_tree.get<std::vector<std::string>>("tolerance_sweep.reductions");
+      std::vector<duneuro_eeg_forward_test::SweepEntry> sweep_entries;
+      for(const std::string& reduction : reductions) {
+        std::cout << "\n Solver reduction " << reduction << "\n";
+        Dune::ParameterTree run_config = config_tree;
+        run_config["solver.reduction"] = reduction;
+        
+        double transfer_time = 0.0;
+        if(transfer_mode) {
+          transfer_time = compute_transfer_matrix(run_config);
+        }
+        RunResult run = run_dipoles(run_config, "_reduction_" + reduction);
+        // the effort is summed over the ranks, the errors are already gathered
+        double iterations = run.iterations;
+        double solve_time = run.solve_time;
+        if(distributed_mode) {
+          iterations = helper.getCommunication().sum(iterations);
+          solve_time = helper.getCommunication().sum(solve_time);
+        }
+        
+        duneuro_eeg_forward_test::SweepEntry entry;
+        entry.label = reduction;
+        // applying the transfer matrix does not iterate, its cost is the computation of the matrix
+        if(transfer_mode) {
+          entry.values.emplace_back("transfer_time", transfer_time);
+        }
+        else {
+          entry.values.emplace_back("iterations", iterations / number_of_dipoles);
+        }
+        entry.values.emplace_back("solve_time", solve_time / number_of_dipoles);
+        entry.errors = std::move(run.errors);
+        sweep_entries.push_back(std::move(entry));
+      }
+      
+      if(helper.rank() == 0) {
+        std::cout << "\n Solver reduction comparison over " << number_of_dipoles << " dipoles, "
+                  << (transfer_mode ? "transfer matrix time, solve time" : "iterations and solve time") << " per dipole\n";
+        duneuro_eeg_forward_test::print_sweep_report(std::cout, "reduction", sweep_entries);
+        if(config_tree.hasKey("tolerance_sweep.filename")) {
+          duneuro_eeg_forward_test::write_sweep_csv(config_tree.get<std::string>("tolerance_sweep.filename"), "reduction", sweep_entries);
+        }
+        std::cout << "\n";
+      }
+    }
+    else if(convergence_mode) {
+      // run the same dipoles and electrodes on a sequence of meshes, either the files in convergence.meshes or
+      // uniform refinements of the input mesh. Every level replaces the driver
+      std::vector<std::string> mesh_filenames = config_tree.get<std::vector<std::string>>("convergence.meshes", {});
+      std::size_t number_of_levels = mesh_filenames.empty() ? config_tree.get<std::size_t>("convergence.levels", 2) : mesh_filenames.size();
+      std::vector<duneuro_eeg_forward_test::SweepEntry> sweep_entries;
+      duneuro_eeg_forward_test::TetrahedralMesh level_mesh;
+      // the generated mesh and its refinements are identified by the generator parameters and the level
+      std::uint64_t level_hash = 0;
+      for(std::size_t level = 0; level < number_of_levels; ++level) {
+        std::string label = mesh_filenames.empty() ? "level_" + std::to_string(level) : mesh_filenames[level];
+        std::cout << "\n Convergence study, " << label << "\n";
+        
+        Dune::Timer setup_timer;
+        {
+          auto stage = profiler.scope("load_mesh", record_memory);
+          if(!mesh_filenames.empty()) {
+            level_mesh = parse(mesh_filenames[level]);
+          }
+          else if(level == 0) {
+            level_mesh = generate_mesh ? make_sphere_mesh() : parse(config_tree.get<std::string>("volume_conductor.grid.filename"));
+            level_hash = generate_mesh ? sphere_mesh_hash() : 0;
+          }
+          else {
+            level_mesh = duneuro_eeg_forward_test::refine_uniformly(level_mesh);
+            level_hash = level_hash != 0 ? duneuro_eeg_forward_test::Hash().add(level_hash).add(level).value() : 0;
+          }
+        }
+        std::size_t number_of_vertices = level_mesh.nodes.size();
+        std::size_t number_of_elements = level_mesh.elements.size();
+        std::cout << " " << number_of_vertices << " vertices, " << number_of_elements << " elements\n";
+        {
+          auto stage = profiler.scope("create_driver", record_memory);
+          // the mesh of the last level is not needed for a further refinement
+          bool last_level = level + 1 == number_of_levels;
+          setup_from_mesh(last_level ? std::move(level_mesh) : level_mesh, level_hash);
+        }
+        double transfer_time = prepare_driver(true);
+        double setup_time = setup_timer.elapsed() - transfer_time;
+        
+        RunResult run = run_dipoles(config_tree, "_" + label.substr(label.find_last_of('/') + 1));
+        double solve_time = run.solve_time;
+        if(distributed_mode) {
+          solve_time = helper.getCommunication().sum(solve_time);
+        }
+        
+        duneuro_eeg_forward_test::SweepEntry entry;
+        entry.label = label;
+        // for P1 elements the degrees of freedom are the vertices
+        entry.values = {{"dofs", static_cast<double>(number_of_vertices)},
+                        {"elements", static_cast<double>(number_of_elements)},
+                        {"setup_time", setup_time}};
+        if(transfer_mode) {
+          entry.values.emplace_back("transfer_time", transfer_time);
+        }
+        entry.values.emplace_back("solve_time", solve_time / number_of_dipoles);
+        entry.values.emplace_back("peak_rss_kb", static_cast<double>(duneuro_eeg_forward_test::peak_rss_kb()));
+        entry.errors = std::move(run.errors);
+        sweep_entries.push_back(std::move(entry));
+      }
+      
+      if(helper.rank() == 0) {
+        std::cout << "\n Mesh convergence over " << number_of_dipoles << " dipoles, setup time per level including mesh, driver and electrodes"
+                  << (transfer_mode ? ", transfer matrix time per level" : "") << ", solve time per dipole, peak memory after the level\n";
+        duneuro_eeg_forward_test::print_sweep_report(std::cout, "mesh", sweep_entries);
+        if(config_tree.hasKey("convergence.filename")) {
+          duneuro_eeg_forward_test::write_sweep_csv(config_tree.get<std::string>("convergence.filename"), "mesh", sweep_entries);
+        }
+        std::cout << "\n";
+      }
+    }
+    else {
+      std::vector<duneuro_eeg_forward_test::DipoleErrors> dipole_errors = run_dipoles(config_tree, "").errors;
+      
+      // summary over all dipoles
+      if(batch_mode && helper.rank() == 0) {
+        std::cout << "\n";
+        duneuro_eeg_forward_test::print_batch_report(std::cout, dipole_errors);
+        if(config_tree.hasKey("batch.filename")) {
+          duneuro_eeg_forward_test::write_batch_csv(config_tree.get<std::string>("batch.filename"), dipole_errors);
+        }
+        std::cout << "\n";
+      }
+    }
+    
+    {
+      // time the main thread spends waiting for the output still being written
+      auto stage = profiler.scope("output_wait", record_memory);
+      output_writer.wait();
+    }
+    
+    if(analytic_cache_ptr) {
+      analytic_cache_ptr->save();
+      std::cout << " Analytical solution cache : " << analytic_cache_ptr->hits() << " hits, " << analytic_cache_ptr->misses() << " misses\n";
+    }
+    
+    // timings of the individual stages, in distributed mode those of rank 0
+    if(helper.rank() == 0) {
+      profiler.report(std::cout);
+      if(config_tree.hasKey("profiling.filename")) {
+        profiler.write_csv(config_tree.get<std::string>("profiling.filename"));
+      }
+      std::cout << "\n";
     }
     
     std::cout << " The program didn't crash!\n";